@@ -0,0 +1,36 @@
+/*
+ * Shared helpers for the benchmark programs.
+ *
+ * Each benchmark is linked against bench_impl.c, which holds the
+ * DA_IMPLEMENTATION translation unit, so library calls cross a real
+ * translation-unit boundary just like in an application.
+ */
+
+#ifndef DA_BENCH_H
+#define DA_BENCH_H
+
+#include <stdio.h>
+#include <time.h>
+
+#include "dynamic_array.h"
+
+static double bench_now(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+#ifdef BENCH_COUNT_ALLOCS
+/* Allocation counters maintained by bench_impl.c */
+extern long long bench_malloc_calls;
+extern long long bench_realloc_calls;
+extern long long bench_free_calls;
+#endif
+
+/* Keeps the optimizer from discarding benchmark results */
+static volatile long long bench_sink;
+
+#define BENCH_REPORT(label, ops, seconds) \
+    printf("%-40s %10.2f Mops/s  (%.3f s)\n", label, (double)(ops) / (seconds) / 1e6, seconds)
+
+#endif /* DA_BENCH_H */
@@ -0,0 +1,66 @@
+/*
+ * Frame-allocation benchmark: each frame builds many short-lived arrays and
+ * drops them all at the end, either by releasing each one (DA_FREE per block)
+ * or by resetting an arena. Counts every DA_MALLOC/DA_REALLOC/DA_FREE call.
+ */
+
+#include "bench.h"
+
+#define FRAMES 1000
+#define ARRAYS_PER_FRAME 1000
+#define ELEMENTS 16
+
+static da_array frame_arrays[ARRAYS_PER_FRAME];
+
+static long long run_frame(da_arena arena) {
+    long long sum = 0;
+    for (int n = 0; n < ARRAYS_PER_FRAME; n++) {
+        da_array arr = arena ? DA_ARENA_NEW(arena, int) : da_new(sizeof(int));
+        for (int i = 0; i < ELEMENTS; i++) {
+            da_push(arr, &i);
+        }
+        sum += *(int*)da_get(arr, n % ELEMENTS);
+        frame_arrays[n] = arr;
+    }
+
+    if (arena) {
+        da_arena_reset(arena);
+    } else {
+        for (int n = 0; n < ARRAYS_PER_FRAME; n++) {
+            da_release(&frame_arrays[n]);
+        }
+    }
+    return sum;
+}
+
+static void report_calls(const char* label, double elapsed, long long mallocs, long long reallocs, long long frees) {
+    BENCH_REPORT(label, (long long)FRAMES * ARRAYS_PER_FRAME, elapsed);
+    printf("  %-38s %10.2f / %.2f / %.2f\n", "malloc / realloc / free per frame",
+           (double)mallocs / FRAMES, (double)reallocs / FRAMES, (double)frees / FRAMES);
+}
+
+int main(void) {
+    long long sum = 0;
+
+    double start = bench_now();
+    for (int f = 0; f < FRAMES; f++) {
+        sum += run_frame(NULL);
+    }
+    double elapsed = bench_now() - start;
+    report_calls("da_new + da_release (arrays)", elapsed, bench_malloc_calls, bench_realloc_calls,
+                 bench_free_calls);
+
+    long long m0 = bench_malloc_calls, r0 = bench_realloc_calls, f0 = bench_free_calls;
+    da_arena arena = da_arena_create(0);
+    start = bench_now();
+    for (int f = 0; f < FRAMES; f++) {
+        sum += run_frame(arena);
+    }
+    elapsed = bench_now() - start;
+    report_calls("arena + da_arena_reset (arrays)", elapsed, bench_malloc_calls - m0, bench_realloc_calls - r0,
+                 bench_free_calls - f0);
+    da_arena_destroy(&arena);
+
+    bench_sink = sum;
+    return 0;
+}
@@ -0,0 +1,69 @@
+/*
+ * Crossover benchmark: random-position insert + remove pairs at several
+ * sizes, on a flat da_array and on a da_bigarray of ints.
+ *
+ * The flat array memmoves half of its elements on average per edit; the
+ * big array moves part of one leaf and updates O(log n) branch counts.
+ * Random da_get vs. da_bigarray_get is reported at the same sizes.
+ */
+
+#include "bench.h"
+
+static unsigned int bench_rand(unsigned int* x) {
+    *x = *x * 1103515245u + 12345u;
+    return *x >> 4;
+}
+
+int main(void) {
+    static const int sizes[] = { 1000, 10000, 30000, 100000, 300000, 1000000, 4000000 };
+    long long sum = 0;
+
+    printf("%10s %14s %14s %14s %14s\n", "elements", "flat edit", "big edit", "flat get", "big get");
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        int n = sizes[s];
+        int edits = n >= 1000000 ? 2000 : 20000;
+        int reads = 1000000;
+
+        da_array flat = da_create(sizeof(int), n + 1, NULL, NULL);
+        da_bigarray big = da_bigarray_create(sizeof(int), NULL, NULL);
+        for (int i = 0; i < n; i++) {
+            da_push(flat, &i);
+            da_bigarray_push(big, &i);
+        }
+
+        unsigned int x = 12345;
+        double start = bench_now();
+        for (int e = 0; e < edits; e++) {
+            da_insert(flat, (da_int_t)(bench_rand(&x) % (unsigned int)(n + 1)), &e);
+            da_remove(flat, (da_int_t)(bench_rand(&x) % (unsigned int)(n + 1)), NULL);
+        }
+        double flat_edit = (double)edits / (bench_now() - start) / 1e6;
+
+        x = 12345;
+        start = bench_now();
+        for (int e = 0; e < edits; e++) {
+            da_bigarray_insert(big, (da_int_t)(bench_rand(&x) % (unsigned int)(n + 1)), &e);
+            da_bigarray_remove(big, (da_int_t)(bench_rand(&x) % (unsigned int)(n + 1)), NULL);
+        }
+        double big_edit = (double)edits / (bench_now() - start) / 1e6;
+
+        start = bench_now();
+        for (int r = 0; r < reads; r++) {
+            sum += *(int*)da_get(flat, (da_int_t)(bench_rand(&x) % (unsigned int)n));
+        }
+        double flat_get = (double)reads / (bench_now() - start) / 1e6;
+
+        start = bench_now();
+        for (int r = 0; r < reads; r++) {
+            sum += *(int*)da_bigarray_get(big, (da_int_t)(bench_rand(&x) % (unsigned int)n));
+        }
+        double big_get = (double)reads / (bench_now() - start) / 1e6;
+
+        printf("%10d %9.3f Mops %9.3f Mops %9.2f Mops %9.2f Mops\n", n, flat_edit, big_edit, flat_get, big_get);
+        da_release(&flat);
+        da_bigarray_destroy(&big);
+    }
+
+    bench_sink = sum;
+    return 0;
+}
@@ -0,0 +1,62 @@
+/*
+ * Copy-on-write benchmark: copies of a managed array that are only read.
+ *
+ * Built as bench_cow (da_copy duplicates the buffer and retains every element)
+ * and bench_cow_shared (DA_COW=1, da_copy shares the buffer). The read loop
+ * checks that da_get on a shared array is as fast as on a private one.
+ */
+
+#include "bench.h"
+
+#define ELEMENTS 4096
+#define COPIES 200000
+#define READS (64 * 1024 * 1024)
+
+static long long retains;
+static void count_retain(void* element) { (void)element; retains++; }
+static void count_release(void* element) { (void)element; }
+
+int main(void) {
+    printf("DA_COW=%d\n", DA_COW);
+
+    da_array source = da_create(sizeof(int), ELEMENTS, count_retain, count_release);
+    for (int i = 0; i < ELEMENTS; i++) {
+        da_push(source, &i);
+    }
+
+    long long sum = 0;
+    retains = 0;
+    double start = bench_now();
+    for (int n = 0; n < COPIES; n++) {
+        da_array copy = da_copy(source);
+        sum += *(int*)da_get(copy, n % ELEMENTS);
+        da_release(&copy);
+    }
+    double elapsed = bench_now() - start;
+    BENCH_REPORT("copy/read/release (4096 elements)", COPIES, elapsed);
+    printf("%-40s %10.1f\n", "retain_fn calls per copy", (double)retains / COPIES);
+
+    /* Random reads through a sharer vs. through the source's own buffer */
+    da_array reader = da_copy(source);
+    unsigned int x = 12345;
+    start = bench_now();
+    for (int n = 0; n < READS; n++) {
+        x = x * 1103515245u + 12345u;
+        sum += *(int*)da_get(reader, (da_int_t)(x % ELEMENTS));
+    }
+    elapsed = bench_now() - start;
+    BENCH_REPORT("da_get on a copy", READS, elapsed);
+    da_release(&reader);
+
+    start = bench_now();
+    for (int n = 0; n < READS; n++) {
+        x = x * 1103515245u + 12345u;
+        sum += *(int*)da_get(source, (da_int_t)(x % ELEMENTS));
+    }
+    elapsed = bench_now() - start;
+    BENCH_REPORT("da_get on the source", READS, elapsed);
+
+    da_release(&source);
+    bench_sink = sum;
+    return 0;
+}
@@ -0,0 +1,48 @@
+/*
+ * Work-queue benchmark: a FIFO that stays about QUEUED items deep.
+ *
+ * Compares da_push + da_remove(arr, 0) on a plain array (every dequeue
+ * moves the whole queue down one slot) with da_deque_push + da_deque_shift
+ * on a ring buffer (O(1) at both ends).
+ */
+
+#include "bench.h"
+
+#define QUEUED 10000
+#define OPS 2000000
+
+int main(void) {
+    long long sum = 0;
+
+    da_array queue = da_create(sizeof(int), QUEUED + 1, NULL, NULL);
+    for (int i = 0; i < QUEUED; i++) {
+        da_push(queue, &i);
+    }
+    double start = bench_now();
+    for (int n = 0; n < OPS; n++) {
+        sum += *(int*)da_get(queue, 0);
+        da_remove(queue, 0, NULL);
+        da_push(queue, &n);
+    }
+    double elapsed = bench_now() - start;
+    BENCH_REPORT("da_remove(0)/da_push", OPS, elapsed);
+    da_release(&queue);
+
+    da_deque deque = da_deque_create(sizeof(int), QUEUED + 1, NULL, NULL);
+    for (int i = 0; i < QUEUED; i++) {
+        da_deque_push(deque, &i);
+    }
+    start = bench_now();
+    for (int n = 0; n < OPS; n++) {
+        int out;
+        da_deque_shift(deque, &out);
+        sum += out;
+        da_deque_push(deque, &n);
+    }
+    elapsed = bench_now() - start;
+    BENCH_REPORT("da_deque_shift/da_deque_push", OPS, elapsed);
+    da_deque_destroy(&deque);
+
+    bench_sink = sum;
+    return 0;
+}
@@ -0,0 +1,49 @@
+/*
+ * Empty-result benchmark: filters and slices whose results are mostly empty.
+ *
+ * Built as bench_empty_results (every result is a new array) and
+ * bench_empty_results_shared (DA_SHARED_EMPTY=1, empty results share one header).
+ * Both count every DA_MALLOC/DA_REALLOC/DA_FREE call.
+ */
+
+#include "bench.h"
+
+#define QUERIES 2000000
+#define ITEMS 16
+
+/* Matches roughly one query in ten */
+static int matches_key(const void* element, void* context) {
+    return *(const int*)element == *(const int*)context;
+}
+
+int main(void) {
+    printf("DA_SHARED_EMPTY=%d\n", DA_SHARED_EMPTY);
+
+    da_array items = da_new(sizeof(int));
+    for (int i = 0; i < ITEMS; i++) {
+        int value = i * 10;
+        da_push(items, &value);
+    }
+    long long mallocs_before = bench_malloc_calls;
+
+    long long found = 0;
+    double start = bench_now();
+    for (int q = 0; q < QUERIES; q++) {
+        int key = q % (ITEMS * 10);
+        da_array hits = da_filter(items, matches_key, &key);
+        da_array tail = da_slice(items, ITEMS - q % 2, ITEMS - q % 2);
+        found += da_length(hits) + da_length(tail);
+        da_release(&hits);
+        da_release(&tail);
+    }
+    double elapsed = bench_now() - start;
+
+    BENCH_REPORT("filter+slice/release", QUERIES, elapsed);
+    printf("%-40s %10lld\n", "results found", found);
+    printf("%-40s %10lld\n", "DA_MALLOC calls", bench_malloc_calls - mallocs_before);
+    printf("%-40s %10.2f\n", "allocations per query", (double)(bench_malloc_calls - mallocs_before) / QUERIES);
+
+    da_release(&items);
+    bench_sink = found;
+    return 0;
+}
@@ -0,0 +1,45 @@
+/*
+ * Fast-path benchmark: da_push/da_get/da_length in a tight loop.
+ *
+ * Built twice: bench_fastpath uses the extern definitions from bench_impl.c,
+ * bench_fastpath_inline uses DA_INLINE_FASTPATH=1. Compare the two outputs.
+ */
+
+#include "bench.h"
+
+#define N 10000000
+#define ROUNDS 10
+
+int main(void) {
+    printf("DA_INLINE_FASTPATH=%d\n", DA_INLINE_FASTPATH);
+
+    da_array arr = da_new(sizeof(int));
+
+    double start = bench_now();
+    for (int i = 0; i < N; i++) {
+        da_push(arr, &i);
+    }
+    BENCH_REPORT("da_push", N, bench_now() - start);
+
+    long long sum = 0;
+    start = bench_now();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int i = 0; i < da_length(arr); i++) {
+            sum += *(int*)da_get(arr, i);
+        }
+    }
+    BENCH_REPORT("da_get + da_length", (double)N * ROUNDS, bench_now() - start);
+
+    start = bench_now();
+    for (int r = 0; r < ROUNDS; r++) {
+        int* data = (int*)da_data(arr);
+        for (int i = 0; i < da_length(arr); i++) {
+            sum += data[i];
+        }
+    }
+    BENCH_REPORT("da_data (baseline)", (double)N * ROUNDS, bench_now() - start);
+
+    bench_sink = sum;
+    da_release(&arr);
+    return 0;
+}
@@ -0,0 +1,61 @@
+/*
+ * Editing benchmark: keystrokes near a cursor in a 1 MB character buffer.
+ *
+ * Each round types a few characters, deletes one with backspace, and
+ * sometimes moves the cursor a short distance. da_insert/da_remove move
+ * the whole tail on every keystroke; the gap buffer only moves the
+ * elements between the previous and the current edit.
+ */
+
+#include "bench.h"
+
+#define TEXT_BYTES (1 << 20)
+#define ROUNDS 20000
+
+int main(void) {
+    long long sum = 0;
+    char fill = 'x';
+
+    da_array arr = da_create(sizeof(char), TEXT_BYTES + 4 * ROUNDS, NULL, NULL);
+    da_fill(arr, &fill, TEXT_BYTES);
+    da_int_t cursor = TEXT_BYTES / 4;
+    unsigned int x = 12345;
+    double start = bench_now();
+    for (int n = 0; n < ROUNDS; n++) {
+        char ch = (char)('a' + n % 26);
+        for (int k = 0; k < 3; k++) {
+            da_insert(arr, cursor++, &ch);
+        }
+        da_remove(arr, --cursor, NULL);
+        x = x * 1103515245u + 12345u;
+        if (x % 8 == 0) cursor -= (da_int_t)(x >> 8) % 64;
+    }
+    double elapsed = bench_now() - start;
+    BENCH_REPORT("da_insert/da_remove", ROUNDS * 4, elapsed);
+    sum += *(char*)da_get(arr, cursor);
+    da_release(&arr);
+
+    da_gap gap = da_gap_create(sizeof(char), TEXT_BYTES + 4 * ROUNDS, NULL, NULL);
+    for (int i = 0; i < TEXT_BYTES; i++) {
+        da_gap_push(gap, &fill);
+    }
+    cursor = TEXT_BYTES / 4;
+    x = 12345;
+    start = bench_now();
+    for (int n = 0; n < ROUNDS; n++) {
+        char ch = (char)('a' + n % 26);
+        for (int k = 0; k < 3; k++) {
+            da_gap_insert(gap, cursor++, &ch);
+        }
+        da_gap_remove(gap, --cursor, NULL);
+        x = x * 1103515245u + 12345u;
+        if (x % 8 == 0) cursor -= (da_int_t)(x >> 8) % 64;
+    }
+    elapsed = bench_now() - start;
+    BENCH_REPORT("da_gap_insert/da_gap_remove", ROUNDS * 4, elapsed);
+    sum += *(char*)da_gap_get(gap, cursor);
+    da_gap_destroy(&gap);
+
+    bench_sink = sum;
+    return 0;
+}
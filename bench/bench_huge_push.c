@@ -0,0 +1,41 @@
+/*
+ * Huge-array benchmark: push 64M ints (256 MB) one at a time, then trim.
+ *
+ * Built as bench_huge_push (DA_REALLOC growth) and bench_huge_push_mmap
+ * (DA_MMAP_THRESHOLD=1 MiB: mmap storage, mremap growth, munmap on trim).
+ * Reports push throughput and the process peak RSS.
+ */
+
+#include "bench.h"
+
+#include <sys/resource.h>
+
+#define ELEMENTS (64 * 1024 * 1024)
+
+static long peak_rss_mb(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024;  /* ru_maxrss is in KiB on Linux */
+}
+
+int main(void) {
+    printf("DA_MMAP_THRESHOLD=%ld\n", (long)DA_MMAP_THRESHOLD);
+
+    da_array arr = da_new(sizeof(int));
+    double start = bench_now();
+    for (int i = 0; i < ELEMENTS; i++) {
+        da_push(arr, &i);
+    }
+    double elapsed = bench_now() - start;
+    BENCH_REPORT("da_push x 64M ints", ELEMENTS, elapsed);
+    printf("%-40s %10ld MB\n", "peak RSS after pushes", peak_rss_mb());
+
+    da_resize(arr, ELEMENTS / 8);
+    start = bench_now();
+    da_trim(arr, ELEMENTS / 8);
+    printf("%-40s %10.3f ms\n", "da_trim to 1/8", (bench_now() - start) * 1e3);
+
+    bench_sink = *(int*)da_get(arr, ELEMENTS / 8 - 1);
+    da_release(&arr);
+    return 0;
+}
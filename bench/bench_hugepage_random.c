@@ -0,0 +1,82 @@
+/*
+ * Huge-page benchmark: random da_get over a large array, without and with
+ * the transparent huge page hint (da_hugepage_set_threshold).
+ *
+ * Built with DA_MMAP_THRESHOLD=1 MiB so both runs use mmap storage; only the
+ * 2 MB alignment and MADV_HUGEPAGE differ. Pass the array size in MiB as the
+ * first argument (default 512). Results depend on the system THP mode, which
+ * is printed first: with "never" the hint has no effect.
+ */
+
+#include "bench.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LOOKUPS (32 * 1024 * 1024)
+
+static void print_thp_mode(void) {
+    char line[256] = "unavailable";
+    FILE* f = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r");
+    if (f) {
+        if (!fgets(line, sizeof(line), f)) strcpy(line, "unreadable");
+        fclose(f);
+    }
+    line[strcspn(line, "\n")] = '\0';
+    printf("THP mode: %s\n", line);
+}
+
+/* AnonHugePages of the whole process, in MiB (-1 if unknown) */
+static long anon_huge_mb(void) {
+    char line[256];
+    long kb = -1;
+    FILE* f = fopen("/proc/self/smaps_rollup", "r");
+    if (!f) return -1;
+    while (fgets(line, sizeof(line), f)) {
+        if (sscanf(line, "AnonHugePages: %ld kB", &kb) == 1) break;
+    }
+    fclose(f);
+    return kb < 0 ? -1 : kb / 1024;
+}
+
+static void run(const char* label, size_t hint_threshold, da_int_t elements) {
+    da_hugepage_set_threshold(hint_threshold);
+
+    da_array arr = da_new(sizeof(uint32_t));
+    da_reserve(arr, elements);
+    for (da_int_t i = 0; i < elements; i++) {
+        uint32_t v = (uint32_t)i;
+        da_push(arr, &v);
+    }
+
+    uint64_t x = 88172645463325252ULL;
+    uint64_t sum = 0;
+    double start = bench_now();
+    for (int i = 0; i < LOOKUPS; i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        sum += *(const uint32_t*)da_get(arr, (da_int_t)(x % (uint64_t)elements));
+    }
+    double elapsed = bench_now() - start;
+    bench_sink = (long long)sum;
+
+    char name[64];
+    snprintf(name, sizeof(name), "random da_get, %s", label);
+    BENCH_REPORT(name, LOOKUPS, elapsed);
+    printf("%-40s %10ld MB  (data %% 2 MB = %lu)\n", "  AnonHugePages", anon_huge_mb(),
+           (unsigned long)((uintptr_t)da_data(arr) % (2u << 20)));
+    da_release(&arr);
+}
+
+int main(int argc, char** argv) {
+    long mib = argc > 1 ? atol(argv[1]) : 512;
+    da_int_t elements = (da_int_t)(mib * 1024 * 1024 / (long)sizeof(uint32_t));
+
+    print_thp_mode();
+    printf("array: %ld MB, %d lookups\n", mib, LOOKUPS);
+    run("no hint", 0, elements);
+    run("MADV_HUGEPAGE", (size_t)2 << 20, elements);
+    return 0;
+}
@@ -0,0 +1,37 @@
+/* The one translation unit that compiles the library for the benchmarks */
+#include <stdlib.h>
+
+#ifdef BENCH_COUNT_ALLOCS
+/* Route the library's allocations through counters (see bench.h) */
+long long bench_malloc_calls;
+long long bench_realloc_calls;
+long long bench_free_calls;
+
+static void* bench_malloc(size_t size) {
+    bench_malloc_calls++;
+    return malloc(size);
+}
+
+static void* bench_realloc(void* ptr, size_t size) {
+    bench_realloc_calls++;
+    return realloc(ptr, size);
+}
+
+static void bench_free(void* ptr) {
+    bench_free_calls++;
+    free(ptr);
+}
+
+#define DA_MALLOC bench_malloc
+#define DA_REALLOC bench_realloc
+#define DA_FREE bench_free
+
+/* The counters wrap malloc, so its usable size still describes the blocks */
+#if defined(DA_USE_USABLE_SIZE) && DA_USE_USABLE_SIZE && defined(__GLIBC__)
+#include <malloc.h>
+#define DA_MALLOC_USABLE_SIZE(ptr) malloc_usable_size(ptr)
+#endif
+#endif
+
+#define DA_IMPLEMENTATION
+#include "dynamic_array.h"
@@ -0,0 +1,75 @@
+/*
+ * Value-semantics benchmark: "modified copies" of a 100k-element array of
+ * retained values, as an interpreter that treats arrays as values makes them.
+ *
+ * da_copy + da_set copies and retains every element for each new version;
+ * da_pvec_set copies one 32-entry node per trie level and shares the rest.
+ */
+
+#include "bench.h"
+
+#define COUNT 100000
+#define COPY_UPDATES 1000
+#define UPDATES 200000
+
+static long long retain_calls;
+
+static void value_retain(void* element) {
+    (void)element;
+    retain_calls++;
+}
+
+static void value_release(void* element) { (void)element; }
+
+int main(void) {
+    da_array values = da_create(sizeof(int), COUNT, value_retain, value_release);
+    for (int i = 0; i < COUNT; i++) {
+        da_push(values, &i);
+    }
+    long long sum = 0;
+    unsigned int x = 12345;
+
+    da_array current = da_retain(values);
+    retain_calls = 0;
+    double start = bench_now();
+    for (int n = 0; n < COPY_UPDATES; n++) {
+        x = x * 1103515245u + 12345u;
+        da_array next = da_copy(current);
+        da_set(next, (da_int_t)(x % COUNT), &n);
+        da_release(&current);
+        current = next;
+    }
+    double elapsed = bench_now() - start;
+    BENCH_REPORT("da_copy + da_set", COPY_UPDATES, elapsed);
+    printf("%-40s %10.2f us\n", "  per update", elapsed / COPY_UPDATES * 1e6);
+    printf("%-40s %10.1f\n", "  retain calls per update", (double)retain_calls / COPY_UPDATES);
+    sum += *(int*)da_get(current, 0);
+    da_release(&current);
+
+    da_pvec version = da_pvec_from_array(values);
+    x = 12345;
+    retain_calls = 0;
+    start = bench_now();
+    for (int n = 0; n < UPDATES; n++) {
+        x = x * 1103515245u + 12345u;
+        da_pvec next = da_pvec_set(version, (da_int_t)(x % COUNT), &n);
+        da_pvec_release(&version);
+        version = next;
+    }
+    elapsed = bench_now() - start;
+    BENCH_REPORT("da_pvec_set", UPDATES, elapsed);
+    printf("%-40s %10.2f us\n", "  per update", elapsed / UPDATES * 1e6);
+    printf("%-40s %10.1f\n", "  retain calls per update", (double)retain_calls / UPDATES);
+
+    start = bench_now();
+    for (int n = 0; n < COUNT; n++) {
+        sum += *(const int*)da_pvec_get(version, n);
+    }
+    elapsed = bench_now() - start;
+    BENCH_REPORT("da_pvec_get (sequential)", COUNT, elapsed);
+    da_pvec_release(&version);
+
+    da_release(&values);
+    bench_sink = sum;
+    return 0;
+}
@@ -0,0 +1,66 @@
+/*
+ * Concatenation-chain benchmark: join 2000 batches of 1000 ints one after
+ * another, then sum the result.
+ *
+ * Chained da_concat copies everything joined so far on every step
+ * (quadratic). The rope records each join in O(1) and is either streamed
+ * chunk by chunk or flattened once.
+ */
+
+#include "bench.h"
+
+#define BATCHES 2000
+#define BATCH_LENGTH 1000
+
+static void sum_chunk(const void* data, da_int_t count, void* context) {
+    const int* values = (const int*)data;
+    for (da_int_t i = 0; i < count; i++) {
+        *(long long*)context += values[i];
+    }
+}
+
+int main(void) {
+    da_array batch = da_create(sizeof(int), BATCH_LENGTH, NULL, NULL);
+    for (int i = 0; i < BATCH_LENGTH; i++) {
+        da_push(batch, &i);
+    }
+    long long sum = 0;
+
+    double start = bench_now();
+    da_array all = da_create(sizeof(int), 0, NULL, NULL);
+    for (int b = 0; b < BATCHES; b++) {
+        da_array next = da_concat(all, batch);
+        da_release(&all);
+        all = next;
+    }
+    for (da_int_t i = 0; i < da_length(all); i++) {
+        sum += *(int*)da_get(all, i);
+    }
+    double elapsed = bench_now() - start;
+    printf("%-40s %10.2f ms\n", "da_concat chain + sum", elapsed * 1e3);
+    da_release(&all);
+
+    start = bench_now();
+    da_rope rope = da_rope_from_array(batch);
+    for (int b = 1; b < BATCHES; b++) {
+        da_rope next = da_rope_append(rope, batch);
+        da_rope_release(&rope);
+        rope = next;
+    }
+    da_rope_for_each_chunk(rope, sum_chunk, &sum);
+    elapsed = bench_now() - start;
+    printf("%-40s %10.2f ms\n", "da_rope_append chain + chunk sum", elapsed * 1e3);
+
+    start = bench_now();
+    const int* flat = (const int*)da_rope_data(rope);
+    for (da_int_t i = 0; i < da_rope_length(rope); i++) {
+        sum += flat[i];
+    }
+    elapsed = bench_now() - start;
+    printf("%-40s %10.2f ms\n", "  then flatten + sum", elapsed * 1e3);
+    da_rope_release(&rope);
+
+    da_release(&batch);
+    bench_sink = sum;
+    return 0;
+}
@@ -0,0 +1,76 @@
+/*
+ * Growth benchmark: push 32M ints one at a time, then read them back at
+ * random indices.
+ *
+ * da_push doubles and reallocs, copying what it already holds (and
+ * invalidating pointers) on every growth. da_segmented_push adds a new
+ * chunk and never moves an element; da_segmented_get pays for a bit-width
+ * lookup on every access instead. The slowest single growing push shows the
+ * cost of moving what is already stored.
+ */
+
+#include "bench.h"
+
+#define COUNT (32 << 20)
+#define READS (16 << 20)
+
+int main(void) {
+    long long sum = 0;
+
+    double slowest = 0;
+    double start = bench_now();
+    da_array arr = da_create(sizeof(int), 0, NULL, NULL);
+    for (int i = 0; i < COUNT; i++) {
+        if (da_length(arr) == da_capacity(arr)) {
+            double grow_start = bench_now();
+            da_push(arr, &i);
+            double grow = bench_now() - grow_start;
+            if (grow > slowest) slowest = grow;
+        } else {
+            da_push(arr, &i);
+        }
+    }
+    double elapsed = bench_now() - start;
+    BENCH_REPORT("da_push", COUNT, elapsed);
+    printf("%-40s %10.3f ms\n", "  slowest growing push", slowest * 1e3);
+
+    unsigned int x = 12345;
+    start = bench_now();
+    for (int n = 0; n < READS; n++) {
+        x = x * 1103515245u + 12345u;
+        sum += *(int*)da_get(arr, (da_int_t)(x % COUNT));
+    }
+    elapsed = bench_now() - start;
+    BENCH_REPORT("da_get (random)", READS, elapsed);
+    da_release(&arr);
+
+    slowest = 0;
+    start = bench_now();
+    da_segmented seg = da_segmented_create(sizeof(int), 0, NULL, NULL);
+    for (int i = 0; i < COUNT; i++) {
+        if (da_segmented_length(seg) == da_segmented_capacity(seg)) {
+            double grow_start = bench_now();
+            da_segmented_push(seg, &i);
+            double grow = bench_now() - grow_start;
+            if (grow > slowest) slowest = grow;
+        } else {
+            da_segmented_push(seg, &i);
+        }
+    }
+    elapsed = bench_now() - start;
+    BENCH_REPORT("da_segmented_push", COUNT, elapsed);
+    printf("%-40s %10.3f ms\n", "  slowest growing push", slowest * 1e3);
+
+    x = 12345;
+    start = bench_now();
+    for (int n = 0; n < READS; n++) {
+        x = x * 1103515245u + 12345u;
+        sum += *(int*)da_segmented_get(seg, (da_int_t)(x % COUNT));
+    }
+    elapsed = bench_now() - start;
+    BENCH_REPORT("da_segmented_get (random)", READS, elapsed);
+    da_segmented_destroy(&seg);
+
+    bench_sink = sum;
+    return 0;
+}
@@ -0,0 +1,45 @@
+/*
+ * Small-array benchmark: many short-lived arrays of 1-8 elements.
+ *
+ * Built as bench_small_arrays (no small buffer), bench_small_arrays_sbo
+ * (DA_SBO_BYTES=32), bench_small_arrays_pool (DA_HEADER_POOL_SIZE=64) and
+ * bench_small_arrays_usable (DA_USE_USABLE_SIZE=1).
+ * All count every DA_MALLOC/DA_REALLOC/DA_FREE call.
+ */
+
+#include "bench.h"
+
+#define ARRAYS 1000000
+
+int main(void) {
+    printf("DA_SBO_BYTES=%d DA_HEADER_POOL_SIZE=%d\n", DA_SBO_BYTES, DA_HEADER_POOL_SIZE);
+
+    long long sum = 0;
+    double start = bench_now();
+    for (int n = 0; n < ARRAYS; n++) {
+        da_array arr = da_new(sizeof(int));
+        int count = 1 + n % 8;
+        for (int i = 0; i < count; i++) {
+            da_push(arr, &i);
+        }
+        for (int i = 0; i < da_length(arr); i++) {
+            sum += *(int*)da_get(arr, i);
+        }
+        da_release(&arr);
+    }
+    double elapsed = bench_now() - start;
+
+    BENCH_REPORT("create/push/read/release", ARRAYS, elapsed);
+    printf("%-40s %10lld\n", "DA_MALLOC calls", bench_malloc_calls);
+    printf("%-40s %10lld\n", "DA_REALLOC calls", bench_realloc_calls);
+    printf("%-40s %10lld\n", "DA_FREE calls", bench_free_calls);
+    printf("%-40s %10.2f\n", "allocations per array",
+           (double)(bench_malloc_calls + bench_realloc_calls) / ARRAYS);
+#if DA_HEADER_POOL_SIZE > 0
+    da_header_pool_stats pool = da_header_pool_get_stats();
+    printf("%-40s %9.2f%%\n", "header pool hit rate", 100.0 * pool.hits / (pool.hits + pool.misses));
+#endif
+
+    bench_sink = sum;
+    return 0;
+}
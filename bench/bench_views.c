@@ -0,0 +1,54 @@
+/*
+ * Subrange benchmark: many short ranges of one large token array.
+ *
+ * Compares da_slice (allocate, copy, retain every element) with da_view
+ * (retain the parent, read in place) for the same ranges.
+ */
+
+#include "bench.h"
+
+#define TOKENS (1 << 20)
+#define RANGES 2000000
+
+static void token_retain(void* element) { (void)element; }
+static void token_release(void* element) { (void)element; }
+
+int main(void) {
+    da_array tokens = da_create(sizeof(int), TOKENS, token_retain, token_release);
+    for (int i = 0; i < TOKENS; i++) {
+        da_push(tokens, &i);
+    }
+
+    long long sum = 0;
+    unsigned int x = 12345;
+    double start = bench_now();
+    for (int n = 0; n < RANGES; n++) {
+        x = x * 1103515245u + 12345u;
+        da_int_t first = (da_int_t)(x % (TOKENS - 64));
+        da_array range = da_slice(tokens, first, first + 1 + n % 32);
+        for (da_int_t i = 0; i < da_length(range); i++) {
+            sum += *(int*)da_get(range, i);
+        }
+        da_release(&range);
+    }
+    double elapsed = bench_now() - start;
+    BENCH_REPORT("da_slice/read/release", RANGES, elapsed);
+
+    x = 12345;
+    start = bench_now();
+    for (int n = 0; n < RANGES; n++) {
+        x = x * 1103515245u + 12345u;
+        da_int_t first = (da_int_t)(x % (TOKENS - 64));
+        da_view_t range = da_view(tokens, first, first + 1 + n % 32);
+        for (da_int_t i = 0; i < da_view_length(range); i++) {
+            sum += *(const int*)da_view_get(range, i);
+        }
+        da_view_release(&range);
+    }
+    elapsed = bench_now() - start;
+    BENCH_REPORT("da_view/read/release", RANGES, elapsed);
+
+    da_release(&tokens);
+    bench_sink = sum;
+    return 0;
+}
@@ -20,6 +20,20 @@
  * #define DA_ASSERT assert         // custom assert macro
  * #define DA_GROWTH 16             // fixed growth increment (default: doubling)
  * #define DA_ATOMIC_REFCOUNT 1     // enable atomic reference counting (C11 required)
+ * #define DA_SIZE_T 1              // ptrdiff_t lengths/capacities/indices (default: int)
+ * #define DA_INLINE_FASTPATH 1     // static inline da_get/da_data/da_length/da_capacity/da_push
+ * #define DA_SINGLE_ALLOC 1        // store initial elements in the same block as the header
+ * #define DA_SBO_BYTES 32          // inline small buffer inside every array header
+ * #define DA_ARENA_CHUNK_BYTES 65536 // default chunk size for da_arena_create(0)
+ * #define DA_BIGARRAY_LEAF_BYTES 4096 // element bytes per da_bigarray leaf
+ * #define DA_HEADER_POOL_SIZE 64   // per-thread cache of freed array/builder headers
+ * #define DA_BUFFER_CACHE_BYTES (1 << 20) // per-thread cache of freed element buffers
+ * #define DA_USE_USABLE_SIZE 1            // grow capacity into malloc_usable_size() slack
+ * #define DA_REGISTRY 1                   // track live arrays/builders for da_trim_all()
+ * #define DA_SHARED_EMPTY 1               // empty da_copy/da_slice/da_concat/da_filter results share one header
+ * #define DA_COW 1                        // da_copy() shares the buffer until either array is mutated
+ * #define DA_MMAP_THRESHOLD (64 << 20)    // mmap/mremap element storage from this size (Linux)
+ * #define DA_HUGEPAGE_THRESHOLD (64 << 20) // 2 MB-aligned, MADV_HUGEPAGE storage from this size (Linux)
  *
  * #define DA_IMPLEMENTATION
  * #include "dynamic_array.h"
@@ -64,6 +78,9 @@
 #define DYNAMIC_ARRAY_H
 
 #include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <limits.h>
 #include <string.h>
 #include <assert.h>
 
@@ -76,6 +93,7 @@
 /** @brief Custom memory allocator (default: malloc) */
 #ifndef DA_MALLOC
 #define DA_MALLOC malloc
+#define DA_MALLOC_IS_LIBC 1
 #endif
 
 /** @brief Custom memory reallocator (default: realloc) */
@@ -101,6 +119,147 @@
     #endif
 #endif
 
+/**
+ * @brief Use pointer-sized lengths, capacities, indices and element sizes (default: 0 = int)
+ * @note Selects ptrdiff_t for da_int_t so arrays can exceed 2 GB on 64-bit targets;
+ *       it stays signed so da_find_index() can keep returning -1
+ * @note In either mode, the byte size of every allocation must fit da_int_t; growth, copy
+ *       and concatenation paths assert on overflow instead of wrapping
+ * @warning Must be defined identically in every translation unit, including the one with DA_IMPLEMENTATION
+ */
+#ifndef DA_SIZE_T
+#define DA_SIZE_T 0
+#endif
+
+/**
+ * @brief Expose the hot accessors as static inline functions (default: 0)
+ * @note Affects da_get(), da_data(), da_length(), da_capacity() and da_push()
+ * @note Growth stays out of line in da_grow() so the inlined push stays small
+ * @warning Must be defined identically in every translation unit, including the one with DA_IMPLEMENTATION
+ */
+#ifndef DA_INLINE_FASTPATH
+#define DA_INLINE_FASTPATH 0
+#endif
+
+/**
+ * @brief Allocate header and initial element storage as one block (default: 0)
+ * @note da_create() and the copy/slice/concat/map/builder results place their
+ *       elements directly after the da_array_t header
+ * @note Growth beyond the co-allocated capacity moves the elements to a separate
+ *       heap buffer (the header cannot move because handles are shared by value);
+ *       trimming back to the co-allocated capacity moves them home again
+ */
+#ifndef DA_SINGLE_ALLOC
+#define DA_SINGLE_ALLOC 0
+#endif
+
+/**
+ * @brief Size in bytes of the small buffer embedded in every array header (default: 0 = disabled)
+ * @note Arrays keep their elements in the small buffer until they overflow it,
+ *       so short arrays never allocate element storage
+ * @note Moving to heap storage is transparent: da_get(), da_data() and the
+ *       builder APIs behave identically before and after
+ * @note Every da_array_t grows by DA_SBO_BYTES (rounded up for alignment)
+ */
+#ifndef DA_SBO_BYTES
+#define DA_SBO_BYTES 0
+#endif
+
+/* Element storage can live inside the header block (co-allocated tail or small buffer) */
+#if DA_SINGLE_ALLOC || DA_SBO_BYTES > 0
+    #define DA_HAS_INLINE_STORAGE 1
+#else
+    #define DA_HAS_INLINE_STORAGE 0
+#endif
+
+/**
+ * @brief Default chunk size in bytes for arenas created with da_arena_create(0) (default: 65536)
+ */
+#ifndef DA_ARENA_CHUNK_BYTES
+#define DA_ARENA_CHUNK_BYTES 65536
+#endif
+
+/**
+ * @brief Bytes of elements in each leaf of a da_bigarray (default: 4096)
+ * @note Leaves hold at least 4 elements whatever the element size
+ */
+#ifndef DA_BIGARRAY_LEAF_BYTES
+#define DA_BIGARRAY_LEAF_BYTES 4096
+#endif
+
+/**
+ * @brief Number of freed headers each thread keeps for reuse, per header kind (default: 0 = disabled)
+ * @note Recycles da_array_t and da_builder_t headers of arrays and builders that use the
+ *       default allocator, so da_new/da_copy/da_slice/da_release etc. skip DA_MALLOC/DA_FREE
+ * @note The pool is thread-local where the compiler supports it; see da_header_pool_get_stats()
+ * @note Co-allocated DA_SINGLE_ALLOC blocks larger than a bare header are never pooled
+ */
+#ifndef DA_HEADER_POOL_SIZE
+#define DA_HEADER_POOL_SIZE 0
+#endif
+
+/**
+ * @brief High-water limit in bytes of freed element buffers each thread keeps for reuse (default: 0 = disabled)
+ * @note Buffers are grouped into power-of-two size classes (16 bytes to 16 MiB); element storage
+ *       of arrays and builders on the default allocator is allocated at class size, so creation,
+ *       da_reserve() and growth take a cached buffer of the right class before calling DA_MALLOC
+ * @note Growth within a size class needs no reallocation at all
+ * @note Freed buffers that would push the cache above the limit go straight to DA_FREE;
+ *       da_buffer_cache_trim() releases cached buffers on demand
+ */
+#ifndef DA_BUFFER_CACHE_BYTES
+#define DA_BUFFER_CACHE_BYTES 0
+#endif
+
+/**
+ * @brief Let capacity grow into the slack of the blocks DA_MALLOC/DA_REALLOC return (default: 0)
+ * @note After growth and da_create(), capacity becomes the number of whole elements that fit
+ *       the block's usable size, so later pushes skip reallocations
+ * @note Usable sizes come from DA_MALLOC_USABLE_SIZE(ptr), which defaults to malloc_usable_size()
+ *       (glibc), malloc_size() (macOS) or _msize() (Windows) when DA_MALLOC is malloc; define it
+ *       yourself for a custom DA_MALLOC, otherwise only buffer cache and mmap rounding are used
+ * @note Custom allocators opt in per allocator through da_allocator::usable_size_fn
+ */
+#ifndef DA_USE_USABLE_SIZE
+#define DA_USE_USABLE_SIZE 0
+#endif
+
+/**
+ * @brief Byte size from which mmap element storage is 2 MB aligned and advised MADV_HUGEPAGE (default: 0 = disabled)
+ * @note Linux only; backs transparent huge pages to cut TLB misses on random access to large arrays
+ * @note Implies DA_MMAP_THRESHOLD = DA_HUGEPAGE_THRESHOLD unless that is set; only mmap storage is hinted
+ * @note da_hugepage_set_threshold() changes the threshold at runtime
+ */
+#ifndef DA_HUGEPAGE_THRESHOLD
+#define DA_HUGEPAGE_THRESHOLD 0
+#endif
+
+/**
+ * @brief Byte size from which element storage is anonymous mmap memory (default: 0 = disabled)
+ * @note Linux only; ignored on other platforms
+ * @note Growth uses mremap(MREMAP_MAYMOVE), so pages are remapped rather than copied and
+ *       the old and new buffers never coexist; da_trim() and shrinking munmap the tail pages
+ * @note Applies to arrays and builders on the default allocator; storage that shrinks
+ *       below the threshold moves back to the heap
+ */
+#ifndef DA_MMAP_THRESHOLD
+#define DA_MMAP_THRESHOLD DA_HUGEPAGE_THRESHOLD
+#endif
+
+#if DA_MMAP_THRESHOLD > 0 && defined(__linux__)
+    #define DA_HAS_MMAP 1
+#else
+    #define DA_HAS_MMAP 0
+#endif
+
+/**
+ * @brief Assertion used by the inline fast path (default: DA_ASSERT)
+ * @note Define as ((void)0) to drop bounds checks from inlined accessors only
+ */
+#ifndef DA_FASTPATH_ASSERT
+#define DA_FASTPATH_ASSERT DA_ASSERT
+#endif
+
 /**
  * @brief Enable atomic reference counting (default: 0)
  * @note Requires C11 and stdatomic.h support
@@ -111,12 +270,53 @@
 #define DA_ATOMIC_REFCOUNT 0
 #endif
 
+/**
+ * @brief Keep a process-wide registry of live arrays and builders (default: 0)
+ * @note Enables da_trim_all(), da_registry_get_stats() and da_registry_for_each()
+ * @note Adds two pointers to every header and a short spinlock around create/release
+ * @note Arrays allocated from an arena are not registered (da_arena_reset() drops them wholesale)
+ */
+#ifndef DA_REGISTRY
+#define DA_REGISTRY 0
+#endif
+
+/**
+ * @brief Return a shared, immortal empty array from da_copy/da_slice/da_concat/da_filter (default: 0)
+ * @note Applies when the result is empty and would be a plain array: element size up to
+ *       DA_SHARED_EMPTY_MAX_ELEMENT_SIZE, no retain/release, default allocator, alignment and growth
+ * @note The sentinel costs no allocation; da_retain() and da_release() on it do not touch the count
+ * @note It is read-only: call da_ensure_mutable(&arr) before mutating a result that may be shared;
+ *       mutating the sentinel itself aborts, even under NDEBUG, instead of corrupting every later empty result
+ */
+#ifndef DA_SHARED_EMPTY
+#define DA_SHARED_EMPTY 0
+#endif
+
+/** @brief Largest element size with a shared empty sentinel (one static header per size) */
+#define DA_SHARED_EMPTY_MAX_ELEMENT_SIZE 64
+
+/**
+ * @brief Copy-on-write da_copy() (default: 0)
+ * @note da_copy() shares the source's heap buffer and bumps a buffer-level count instead of
+ *       copying the elements and calling retain_fn; the first mutation of any sharer gives it a private copy
+ * @note Sharers report capacity == length, so the da_push() fast path and all reads stay unchanged
+ * @note Writes through pointers from da_get()/da_data() or typed _at()/_data() bypass the check: call da_unshare() first
+ * @note da_copy() updates the source header when it first shares its buffer; the buffer count is atomic
+ *       with DA_ATOMIC_REFCOUNT=1
+ */
+#ifndef DA_COW
+#define DA_COW 0
+#endif
+
 /** @} */ // end of config group
 
 /* Check C11 support for atomic operations */
 #if DA_ATOMIC_REFCOUNT && __STDC_VERSION__ < 201112L
     #error "DA_ATOMIC_REFCOUNT requires C11 or later for atomic support (compile with -std=c11 or later)"
 #endif
+#if DA_REGISTRY && __STDC_VERSION__ < 201112L
+    #error "DA_REGISTRY requires C11 or later for its lock (compile with -std=c11 or later)"
+#endif
 
 /* atomic operations */
 #if DA_ATOMIC_REFCOUNT
@@ -128,12 +328,55 @@
     #define DA_ATOMIC_STORE(ptr, val) atomic_store(ptr, val)
 #else
     #define DA_ATOMIC_INT int
-    #define DA_ATOMIC_FETCH_ADD(ptr, val) (*(ptr) += (val), *(ptr) - (val))
-    #define DA_ATOMIC_FETCH_SUB(ptr, val) (*(ptr) -= (val), *(ptr) + (val))
+    #define DA_ATOMIC_FETCH_ADD(ptr, val) da_plain_fetch_add(ptr, val)
+    #define DA_ATOMIC_FETCH_SUB(ptr, val) da_plain_fetch_add(ptr, -(val))
     #define DA_ATOMIC_LOAD(ptr) (*(ptr))
     #define DA_ATOMIC_STORE(ptr, val) (*(ptr) = (val))
 #endif
 
+#if defined(__cplusplus) || (defined(__STDC_VERSION__) && __STDC_VERSION__ >= 199901L)
+    #define DA_INLINE static inline
+#elif defined(_MSC_VER)
+    #define DA_INLINE static __inline
+#else
+    #define DA_INLINE static
+#endif
+
+#if !DA_ATOMIC_REFCOUNT
+/* A function rather than a comma expression, so callers may discard the old value without a warning */
+DA_INLINE int da_plain_fetch_add(int* ptr, int val) {
+    int old = *ptr;
+    *ptr += val;
+    return old;
+}
+#endif
+
+/* thread-local storage for per-thread caches (plain static if unsupported) */
+#if defined(__cplusplus) && __cplusplus >= 201103L
+    #define DA_THREAD_LOCAL thread_local
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_THREADS__)
+    #define DA_THREAD_LOCAL _Thread_local
+#elif defined(__GNUC__) || defined(__clang__)
+    #define DA_THREAD_LOCAL __thread
+#elif defined(_MSC_VER)
+    #define DA_THREAD_LOCAL __declspec(thread)
+#else
+    #define DA_THREAD_LOCAL
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+    #define DA_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#else
+    #define DA_UNLIKELY(x) (x)
+#endif
+
+/* linkage of the fast-path accessors */
+#if DA_INLINE_FASTPATH
+    #define DA_FASTPATH_DEF DA_INLINE
+#else
+    #define DA_FASTPATH_DEF DA_DEF
+#endif
+
 /* Detect C23/C++11 auto support (preferred) or typeof fallback */
 #if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 202311L && !defined(__STDC_NO_TYPEOF__)
     #define DA_TYPEOF(x) typeof(x)     /* the C23 typeof keyword */
@@ -184,34 +427,252 @@
  * @{
  */
 
+/**
+ * @brief Integer type of lengths, capacities, indices and element sizes
+ * @note int by default, ptrdiff_t when DA_SIZE_T=1
+ */
+#if DA_SIZE_T
+typedef ptrdiff_t da_int_t;
+#define DA_INT_MAX PTRDIFF_MAX
+#else
+typedef int da_int_t;
+#define DA_INT_MAX INT_MAX
+#endif
+
+/**
+ * @brief Allocator interface that can be attached to individual arrays and builders
+ * @note Arrays and builders created without an allocator (NULL) use DA_MALLOC/DA_REALLOC/DA_FREE
+ * @note Sizes are passed to every call so that arena/pool allocators need no bookkeeping
+ * @note realloc_fn may be NULL, in which case alloc_fn + memcpy + free_fn is used
+ * @note usable_size_fn may be NULL (or omitted from an initializer), in which case capacity is exact
+ * @note The allocator must outlive every array and builder that uses it
+ */
+typedef struct da_allocator {
+    void* (*alloc_fn)(void* context, size_t size);                                   /**< @brief Allocates size bytes (NULL on failure) */
+    void* (*realloc_fn)(void* context, void* ptr, size_t old_size, size_t new_size); /**< @brief Resizes a block (optional) */
+    void (*free_fn)(void* context, void* ptr, size_t size);                          /**< @brief Frees a block of the given size */
+    void* context;                                                                   /**< @brief User context passed to every call */
+    /** @brief Optional: usable bytes of a block allocated with the given size; growth then uses the slack and
+     *         later realloc_fn/free_fn calls pass sizes up to that usable size */
+    size_t (*usable_size_fn)(void* context, void* ptr, size_t size);
+} da_allocator;
+
+/**
+ * @brief Growth strategies selectable per array or builder with da_set_growth() / da_builder_set_growth()
+ */
+typedef enum {
+    DA_GROW_DOUBLE,      /**< @brief Capacity doubles (powers-of-two multiples of the current capacity) */
+    DA_GROW_1_5X,        /**< @brief Capacity grows by half, or to the requested size if that is larger */
+    DA_GROW_FIXED,       /**< @brief Capacity grows in multiples of step elements */
+    DA_GROW_SIZE_CLASS,  /**< @brief 1.5x, rounded up to the next jemalloc-style byte size class */
+    DA_GROW_CALLBACK     /**< @brief Capacity is chosen by callback */
+} da_growth_kind;
+
+/**
+ * @brief Growth (and optional shrink) policy that can be attached to individual arrays and builders
+ * @note Arrays without a policy (NULL) use DA_GROWTH if defined, otherwise doubling;
+ *       builders without one double
+ * @note With shrink_divisor = d > 2, da_pop(), da_remove(), da_remove_range() and da_clear() shrink
+ *       capacity to 2 * length once length < capacity / d; the gap between the two thresholds is
+ *       the hysteresis that keeps a push/pop loop at either boundary from reallocating
+ * @note Size classes are 16, 32, 48, 64, then four per power of two (80, 96, 112, 128, 160, ...),
+ *       so the byte size of the buffer matches what a size-class allocator hands out anyway
+ * @note The policy must outlive every array and builder that uses it
+ *
+ * @code
+ * static const da_growth_policy grow_slowly = { DA_GROW_1_5X, 0, NULL, NULL, 0, 0 };
+ * da_set_growth(arr, &grow_slowly);
+ *
+ * // Doubling, and back to 2 * length once a quarter full or less (never below 16)
+ * static const da_growth_policy elastic = { DA_GROW_DOUBLE, 0, NULL, NULL, 4, 16 };
+ * @endcode
+ */
+typedef struct da_growth_policy {
+    da_growth_kind kind;  /**< @brief Strategy */
+    da_int_t step;        /**< @brief Elements per step for DA_GROW_FIXED (must be > 0) */
+    /** @brief DA_GROW_CALLBACK: returns the new capacity, which must be >= min_needed */
+    da_int_t (*callback)(void* context, da_int_t current_capacity, da_int_t min_needed, da_int_t element_size);
+    void* context;        /**< @brief User context passed to callback */
+    da_int_t shrink_divisor;      /**< @brief Shrink when length < capacity / shrink_divisor (0 = never, else > 2) */
+    da_int_t shrink_min_capacity; /**< @brief Capacity that automatic shrinking never goes below */
+} da_growth_policy;
+
+/**
+ * @brief Control block of an element buffer shared by copy-on-write arrays (DA_COW=1)
+ */
+typedef struct da_shared_buffer {
+    DA_ATOMIC_INT ref_count;  /**< @brief Arrays sharing the buffer */
+    da_int_t capacity;        /**< @brief Capacity of the buffer in elements (sharers report their length) */
+} da_shared_buffer;
+
 /**
  * @brief Reference-counted dynamic array structure
  * @note Do not access fields directly - use provided functions and macros
  * @note Atomic reference counting when DA_ATOMIC_REFCOUNT=1
  */
-typedef struct {
+typedef struct da_array_s {
     DA_ATOMIC_INT ref_count;  /**< @brief Reference count (atomic if DA_ATOMIC_REFCOUNT=1) */
-    int length;               /**< @brief Current number of elements */
-    int capacity;             /**< @brief Allocated capacity */
-    int element_size;         /**< @brief Size of each element in bytes */
+    int alignment;            /**< @brief Required alignment of data in bytes (0 = allocator default) */
+    da_int_t length;          /**< @brief Current number of elements */
+    da_int_t capacity;        /**< @brief Allocated capacity */
+    da_int_t element_size;    /**< @brief Size of each element in bytes */
     void *data;               /**< @brief Pointer to element data */
     void (*retain_fn)(void*); /**< @brief Optional retain function called when elements added (NULL if not needed) */
     void (*release_fn)(void*); /**< @brief Optional release function called when elements removed (NULL if not needed) */
+    const da_allocator* allocator; /**< @brief Allocator for header and elements (NULL = DA_MALLOC/DA_REALLOC/DA_FREE) */
+    const da_growth_policy* growth; /**< @brief Growth policy (NULL = DA_GROWTH or doubling) */
+#if DA_COW
+    da_shared_buffer* shared; /**< @brief Control block while data is shared copy-on-write (NULL = private) */
+#endif
+#if DA_REGISTRY
+    struct da_array_s* registry_prev; /**< @brief Neighbours in the live-array registry */
+    struct da_array_s* registry_next;
+#endif
+#if DA_HAS_INLINE_STORAGE
+    da_int_t inline_capacity; /**< @brief Capacity of the element storage inside the header block */
+#endif
+#if DA_SBO_BYTES > 0
+    union {
+        unsigned char bytes[DA_SBO_BYTES];
+        void* align_ptr;
+        long long align_int;
+        double align_double;
+    } sbo;                    /**< @brief Small buffer holding elements until they overflow it */
+#endif
 } da_array_t, *da_array;
 
 /**
  * @brief ArrayBuffer-style builder for efficient array construction
  * @note Not thread-safe
- * @note Always uses doubling growth strategy for fast construction
+ * @note Doubles by default for fast construction; follows the policy set with da_builder_set_growth()
  * @note Convert to da_array with da_builder_to_array() for sharing/efficiency
  */
-typedef struct {
-    int length;               /**< @brief Current number of elements */
-    int capacity;             /**< @brief Allocated capacity */
-    int element_size;         /**< @brief Size of each element in bytes */
+typedef struct da_builder_s {
+    da_int_t length;          /**< @brief Current number of elements */
+    da_int_t capacity;        /**< @brief Allocated capacity */
+    da_int_t element_size;    /**< @brief Size of each element in bytes */
     void *data;               /**< @brief Pointer to element data */
+    const da_allocator* allocator; /**< @brief Allocator for header and elements (NULL = DA_MALLOC/DA_REALLOC/DA_FREE) */
+    const da_growth_policy* growth; /**< @brief Growth policy (NULL = doubling) */
+    int alignment;            /**< @brief Required alignment of data in bytes (0 = allocator default) */
+#if DA_REGISTRY
+    struct da_builder_s* registry_prev; /**< @brief Neighbours in the live-builder registry */
+    struct da_builder_s* registry_next;
+#endif
 } da_builder_t, *da_builder;
 
+/**
+ * @brief Double-ended queue: a ring buffer with O(1) push/pop at both ends
+ * @note Not reference-counted and not thread-safe (like da_builder)
+ * @note Elements live at data[(head + i) % capacity]; da_deque_linearize() makes them contiguous
+ */
+typedef struct da_deque_s {
+    da_int_t head;            /**< @brief Slot of the first element */
+    da_int_t length;          /**< @brief Current number of elements */
+    da_int_t capacity;        /**< @brief Allocated capacity */
+    da_int_t element_size;    /**< @brief Size of each element in bytes */
+    void *data;               /**< @brief Pointer to the ring buffer */
+    void (*retain_fn)(void*); /**< @brief Optional retain function called when elements are added */
+    void (*release_fn)(void*); /**< @brief Optional release function called when elements are removed */
+    const da_allocator* allocator; /**< @brief Allocator for header and elements (NULL = DA_MALLOC/DA_REALLOC/DA_FREE) */
+} da_deque_t, *da_deque;
+
+/**
+ * @brief Maximum number of chunks in a da_segmented (one per bit of da_int_t)
+ */
+#define DA_SEGMENTED_MAX_CHUNKS ((int)(sizeof(da_int_t) * CHAR_BIT))
+
+/**
+ * @brief Segmented array: geometrically sized chunks whose elements never move
+ * @note Chunk k holds first_chunk << k elements, so index i lives in chunk
+ *       bit_width(i + first_chunk) - 1 - log2(first_chunk)
+ * @note Not reference-counted and not thread-safe (like da_builder)
+ */
+typedef struct da_segmented_s {
+    da_int_t length;          /**< @brief Current number of elements */
+    da_int_t element_size;    /**< @brief Size of each element in bytes */
+    int first_chunk_shift;    /**< @brief log2 of the first chunk's element count */
+    int chunk_count;          /**< @brief Number of allocated chunks */
+    void* chunks[DA_SEGMENTED_MAX_CHUNKS]; /**< @brief Chunk k holds elements [(2^k - 1) * first, (2^(k+1) - 1) * first) */
+    void (*retain_fn)(void*); /**< @brief Optional retain function called when elements are added */
+    void (*release_fn)(void*); /**< @brief Optional release function called when elements are removed */
+    const da_allocator* allocator; /**< @brief Allocator for header and chunks (NULL = DA_MALLOC/DA_REALLOC/DA_FREE) */
+} da_segmented_t, *da_segmented;
+
+/**
+ * @brief Gap buffer: an array that keeps its free space at the last edit position
+ * @note Elements [0, gap_start) sit before the gap and the rest at [gap_end, capacity),
+ *       so inserts and removes next to the previous edit move nothing
+ * @note Not reference-counted and not thread-safe (like da_builder)
+ */
+typedef struct da_gap_s {
+    da_int_t gap_start;       /**< @brief Index of the first free slot (the cursor) */
+    da_int_t gap_end;         /**< @brief Slot of the first element after the gap */
+    da_int_t capacity;        /**< @brief Allocated capacity */
+    da_int_t element_size;    /**< @brief Size of each element in bytes */
+    void *data;               /**< @brief Pointer to element data */
+    void (*retain_fn)(void*); /**< @brief Optional retain function called when elements are added */
+    void (*release_fn)(void*); /**< @brief Optional release function called when elements are removed */
+    const da_allocator* allocator; /**< @brief Allocator for header and elements (NULL = DA_MALLOC/DA_REALLOC/DA_FREE) */
+} da_gap_t, *da_gap;
+
+struct da_bignode_s;
+
+/**
+ * @brief Counted B-tree sequence: O(log n) get, insert and remove at any index
+ * @note Elements live in leaves of DA_BIGARRAY_LEAF_BYTES; branches store the element
+ *       count of each child, which is how an index finds its leaf
+ * @note Not reference-counted and not thread-safe (like da_builder)
+ */
+typedef struct da_bigarray_s {
+    da_int_t length;          /**< @brief Current number of elements */
+    da_int_t element_size;    /**< @brief Size of each element in bytes */
+    da_int_t leaf_capacity;   /**< @brief Elements per leaf */
+    int height;               /**< @brief Branch levels above the leaves (0 = the root is a leaf) */
+    struct da_bignode_s* root; /**< @brief Root node (NULL until the first insert) */
+    void (*retain_fn)(void*); /**< @brief Optional retain function called when elements are added */
+    void (*release_fn)(void*); /**< @brief Optional release function called when elements are removed */
+    const da_allocator* allocator; /**< @brief Allocator for header and nodes (NULL = DA_MALLOC/DA_REALLOC/DA_FREE) */
+} da_bigarray_t, *da_bigarray;
+
+/**
+ * @brief Persistent vector: an immutable, reference-counted version of a sequence
+ * @note A 32-way trie of da_array nodes plus a tail of up to 32 elements, as in Clojure;
+ *       branches are arrays of da_array whose retain/release functions retain and release
+ *       the children, so versions share every node they have in common
+ * @note Reference counting is atomic if DA_ATOMIC_REFCOUNT=1; the elements are never modified
+ */
+typedef struct da_pvec_s {
+    DA_ATOMIC_INT ref_count;  /**< @brief Reference count (atomic if DA_ATOMIC_REFCOUNT=1) */
+    da_int_t length;          /**< @brief Number of elements */
+    da_int_t element_size;    /**< @brief Size of each element in bytes */
+    int shift;                /**< @brief Index bits consumed above the leaves: 5 * trie depth */
+    da_array root;            /**< @brief Trie of full 32-element leaves (NULL while length <= 32) */
+    da_array tail;            /**< @brief Last 1..32 elements (NULL when empty) */
+    void (*retain_fn)(void*); /**< @brief Optional retain function called when elements are added */
+    void (*release_fn)(void*); /**< @brief Optional release function called when elements are removed */
+    const da_allocator* allocator; /**< @brief Allocator for headers and nodes (NULL = DA_MALLOC/DA_REALLOC/DA_FREE) */
+} da_pvec_t, *da_pvec;
+
+/**
+ * @brief Rope: a lazily concatenated sequence of arrays
+ * @note A leaf retains one da_array; a concatenation retains its two operands. The first
+ *       random access turns a concatenation into a leaf holding the flattened array
+ * @note Reference counting is atomic if DA_ATOMIC_REFCOUNT=1, but the first da_rope_get()/
+ *       da_rope_data() of a concatenation must not race with other reads of the same rope
+ */
+typedef struct da_rope_s {
+    DA_ATOMIC_INT ref_count;  /**< @brief Reference count (atomic if DA_ATOMIC_REFCOUNT=1) */
+    da_int_t length;          /**< @brief Total number of elements */
+    da_int_t element_size;    /**< @brief Size of each element in bytes */
+    da_array leaf;            /**< @brief Elements of a leaf, or the flattened concatenation (NULL until then) */
+    struct da_rope_s* left;   /**< @brief First operand of a concatenation (NULL for leaves) */
+    struct da_rope_s* right;  /**< @brief Second operand of a concatenation (NULL for leaves) */
+    void (*retain_fn)(void*); /**< @brief Retain function of the flattened array (from the first leaf) */
+    void (*release_fn)(void*); /**< @brief Release function of the flattened array (from the first leaf) */
+    const da_allocator* allocator; /**< @brief Allocator for nodes and the flattened array (from the first leaf) */
+} da_rope_t, *da_rope;
+
 /** @} */ // end of types group
 
 /**
@@ -235,7 +696,7 @@ typedef struct {
  * da_release(&arr);
  * @endcode
  */
-DA_DEF da_array da_new(int element_size);
+DA_DEF da_array da_new(da_int_t element_size);
 
 /**
  * @brief Creates a new dynamic array with full configuration
@@ -257,7 +718,73 @@ DA_DEF da_array da_new(int element_size);
  *                           (void(*)(void*))release); // release on remove
  * @endcode
  */
-DA_DEF da_array da_create(int element_size, int initial_capacity, void (*retain_fn)(void*), void (*release_fn)(void*));
+DA_DEF da_array da_create(da_int_t element_size, da_int_t initial_capacity, void (*retain_fn)(void*), void (*release_fn)(void*));
+
+/**
+ * @brief Creates a new dynamic array whose memory comes from a custom allocator
+ * @param element_size Size in bytes of each element (must be > 0)
+ * @param initial_capacity Initial capacity (0 is valid for deferred allocation)
+ * @param retain_fn Optional retain function called when elements are added (NULL if not needed)
+ * @param release_fn Optional release function called when elements are removed (NULL if not needed)
+ * @param allocator Allocator for the header and all element storage (NULL = DA_MALLOC/DA_REALLOC/DA_FREE)
+ * @return New array with ref_count = 1
+ * @note The allocator is stored in the array and used for every later allocation,
+ *       including growth, trimming and release
+ * @note Arrays derived from this one (da_copy, da_slice, da_map, da_filter, and
+ *       da_concat with this as the first argument) inherit the allocator
+ * @note Asserts on allocation failure or invalid parameters
+ *
+ * @code
+ * da_allocator arena_alloc = { arena_alloc_fn, NULL, arena_free_fn, &request_arena };
+ * da_array tmp = da_create_with_allocator(sizeof(int), 16, NULL, NULL, &arena_alloc);
+ * @endcode
+ */
+DA_DEF da_array da_create_with_allocator(da_int_t element_size, da_int_t initial_capacity, void (*retain_fn)(void*),
+                                         void (*release_fn)(void*), const da_allocator* allocator);
+
+/**
+ * @brief Creates a new dynamic array whose data pointer is aligned to the given boundary
+ * @param element_size Size in bytes of each element (must be > 0)
+ * @param initial_capacity Initial capacity (0 is valid for deferred allocation)
+ * @param retain_fn Optional retain function called when elements are added (NULL if not needed)
+ * @param release_fn Optional release function called when elements are removed (NULL if not needed)
+ * @param alignment Power of two between 1 and 4096
+ * @return New array with ref_count = 1
+ * @note Same as da_create() followed by da_set_alignment()
+ *
+ * @code
+ * da_array samples = da_create_aligned(sizeof(float), 1024, NULL, NULL, 64);  // AVX-512 loads
+ * @endcode
+ */
+DA_DEF da_array da_create_aligned(da_int_t element_size, da_int_t initial_capacity, void (*retain_fn)(void*),
+                                  void (*release_fn)(void*), int alignment);
+
+/**
+ * @brief Sets the alignment that da_data() must satisfy, now and after every reallocation
+ * @param arr Array to modify (must not be NULL)
+ * @param alignment Power of two between 1 and 4096
+ * @note Existing storage is moved to a freshly aligned buffer; the array's allocator is used
+ * @note Alignments above 2 * sizeof(void*) over-allocate by the alignment and grow by
+ *       aligned allocation plus copy, since realloc cannot preserve them; inline storage
+ *       (DA_SBO_BYTES, DA_SINGLE_ALLOC) is not used by such arrays
+ * @note Inherited by da_copy(), da_slice(), da_concat() (from the first array), da_map() and da_filter()
+ */
+DA_DEF void da_set_alignment(da_array arr, int alignment);
+
+/**
+ * @brief Sets the growth policy used when pushes, inserts and da_grow() need more capacity
+ * @param arr Array to modify (must not be NULL)
+ * @param policy Policy to use (NULL = DA_GROWTH if defined, otherwise doubling)
+ * @note The policy is not copied; it must outlive the array and arrays derived from it
+ * @note Inherited by da_copy(), da_slice(), da_concat() (from the first array), da_map() and da_filter()
+ * @note da_reserve() and da_resize() are unaffected: they allocate exactly what is asked for
+ *
+ * @code
+ * static const da_growth_policy by_64 = { DA_GROW_FIXED, 64, NULL, NULL };
+ * da_set_growth(arr, &by_64);
+ * @endcode
+ */
+DA_DEF void da_set_growth(da_array arr, const da_growth_policy* policy);
 
 /**
  * @brief Releases a reference to an array, potentially freeing it
@@ -289,6 +816,58 @@ DA_DEF void da_release(da_array* arr);
  */
 DA_DEF da_array da_retain(da_array arr);
 
+/**
+ * @brief Returns an empty array of the given element size without allocating when possible
+ * @param element_size Size in bytes of each element (must be > 0)
+ * @return The shared immortal empty array for element_size (DA_SHARED_EMPTY=1), otherwise da_new(element_size)
+ * @note Release it like any other array; call da_ensure_mutable() before mutating it
+ */
+DA_DEF da_array da_empty(da_int_t element_size);
+
+/**
+ * @brief Replaces a shared empty array with a fresh one that may be mutated
+ * @param arr Pointer to array pointer (updated in place if it pointed at a shared empty array)
+ * @return *arr after the replacement
+ * @note No-op for every other array (and when DA_SHARED_EMPTY is 0)
+ *
+ * @code
+ * da_array hits = da_filter(items, is_hit, NULL);  // may be the shared empty array
+ * da_ensure_mutable(&hits);
+ * DA_PUSH(hits, fallback);
+ * @endcode
+ */
+DA_DEF da_array da_ensure_mutable(da_array* arr);
+
+/**
+ * @brief Aborts if arr is a shared empty array
+ * @param arr Array (must not be NULL)
+ * @note Mutating functions call this themselves; unlike DA_ASSERT it stays on under NDEBUG,
+ *       because a write to the sentinel would show up in every later empty result
+ * @note No-op when DA_SHARED_EMPTY is 0
+ */
+DA_DEF void da_check_mutable(da_array arr);
+
+#if DA_SHARED_EMPTY
+    /* The sentinels have zero capacity, so arrays with storage skip the call */
+    #define DA_CHECK_MUTABLE(arr) do { if (DA_UNLIKELY((arr)->capacity == 0)) da_check_mutable(arr); } while (0)
+#else
+    #define DA_CHECK_MUTABLE(arr) ((void)0)
+#endif
+
+/**
+ * @brief Gives arr a private copy of a buffer it shares copy-on-write
+ * @param arr Array (must not be NULL)
+ * @note Mutating functions do this themselves; call it before writing through da_data()/da_get() pointers
+ * @note No-op for private arrays (and when DA_COW is 0)
+ */
+DA_DEF void da_unshare(da_array arr);
+
+#if DA_COW
+    #define DA_COW_UNSHARE(arr) do { if (DA_UNLIKELY((arr)->shared != NULL)) da_unshare(arr); } while (0)
+#else
+    #define DA_COW_UNSHARE(arr) ((void)0)
+#endif
+
 /** @} */ // end of array_lifecycle group
 
 /**
@@ -304,13 +883,14 @@ DA_DEF da_array da_retain(da_array arr);
  * @return Pointer to element at index
  * @note Asserts on out-of-bounds access
  * @note Returned pointer is valid until array is modified or released
+ * @note static inline when DA_INLINE_FASTPATH=1
  *
  * @code
  * int* ptr = (int*)da_get(arr, 0);
  * *ptr = 42;  // Direct modification
  * @endcode
  */
-DA_DEF void* da_get(da_array arr, int index);
+DA_FASTPATH_DEF void* da_get(da_array arr, da_int_t index);
 
 /**
  * @brief Gets direct pointer to the underlying data array
@@ -319,6 +899,7 @@ DA_DEF void* da_get(da_array arr, int index);
  * @note Enables direct indexing: ((int*)da_data(arr))[i]
  * @note Pointer is valid until array is modified or released
  * @note No bounds checking - use with care
+ * @note static inline when DA_INLINE_FASTPATH=1
  *
  * @code
  * int* data = (int*)da_data(arr);
@@ -326,7 +907,7 @@ DA_DEF void* da_get(da_array arr, int index);
  * data[1] = 99;
  * @endcode
  */
-DA_DEF void* da_data(da_array arr);
+DA_FASTPATH_DEF void* da_data(da_array arr);
 
 /**
  * @brief Sets the value of an element at the specified index
@@ -341,7 +922,7 @@ DA_DEF void* da_data(da_array arr);
  * da_set(arr, 0, &value);
  * @endcode
  */
-DA_DEF void da_set(da_array arr, int index, const void* element);
+DA_DEF void da_set(da_array arr, da_int_t index, const void* element);
 
 /** @} */ // end of array_access group
 
@@ -358,13 +939,14 @@ DA_DEF void da_set(da_array arr, int index, const void* element);
  * @note Automatically grows array capacity if needed
  * @note Asserts on allocation failure or NULL parameters
  * @note Uses configured growth strategy (DA_GROWTH)
+ * @note static inline when DA_INLINE_FASTPATH=1 (growth is delegated to da_grow())
  *
  * @code
  * int value = 42;
  * da_push(arr, &value);
  * @endcode
  */
-DA_DEF void da_push(da_array arr, const void* element);
+DA_FASTPATH_DEF void da_push(da_array arr, const void* element);
 
 /**
  * @brief Inserts an element at the specified index
@@ -382,7 +964,7 @@ DA_DEF void da_push(da_array arr, const void* element);
  * da_insert(arr, da_length(arr), &value);  // Insert at end (same as push)
  * @endcode
  */
-DA_DEF void da_insert(da_array arr, int index, const void* element);
+DA_DEF void da_insert(da_array arr, da_int_t index, const void* element);
 
 /**
  * @brief Removes and optionally returns an element at the specified index
@@ -399,7 +981,7 @@ DA_DEF void da_insert(da_array arr, int index, const void* element);
  * da_remove(arr, 2, NULL);      // Remove third element, discard value
  * @endcode
  */
-DA_DEF void da_remove(da_array arr, int index, void* out);
+DA_DEF void da_remove(da_array arr, da_int_t index, void* out);
 
 /**
  * @brief Removes and optionally returns the last element
@@ -472,6 +1054,7 @@ DA_DEF void* da_peek_first(da_array arr);
  * @brief Gets the current number of elements in the array
  * @param arr Array to query (must not be NULL)
  * @return Number of elements currently in the array
+ * @note static inline when DA_INLINE_FASTPATH=1
  *
  * @code
  * for (int i = 0; i < da_length(arr); i++) {
@@ -479,18 +1062,19 @@ DA_DEF void* da_peek_first(da_array arr);
  * }
  * @endcode
  */
-DA_DEF int da_length(da_array arr);
+DA_FASTPATH_DEF da_int_t da_length(da_array arr);
 
 /**
  * @brief Gets the current allocated capacity of the array
  * @param arr Array to query (must not be NULL)
  * @return Number of elements that can be stored without reallocation
+ * @note static inline when DA_INLINE_FASTPATH=1
  *
  * @code
  * printf("Array using %d/%d slots\n", da_length(arr), da_capacity(arr));
  * @endcode
  */
-DA_DEF int da_capacity(da_array arr);
+DA_FASTPATH_DEF da_int_t da_capacity(da_array arr);
 
 /**
  * @brief Ensures the array has at least the specified capacity
@@ -507,7 +1091,33 @@ DA_DEF int da_capacity(da_array arr);
  * }
  * @endcode
  */
-DA_DEF void da_reserve(da_array arr, int new_capacity);
+DA_DEF void da_reserve(da_array arr, da_int_t new_capacity);
+
+/**
+ * @brief Grows the array so that at least min_capacity elements fit
+ * @param arr Array to modify (must not be NULL)
+ * @param min_capacity Minimum capacity required (must be >= 0)
+ * @note Unlike da_reserve(), rounds up using the array's growth policy (default: DA_GROWTH or doubling)
+ * @note Out-of-line slow path shared by da_push(), da_insert(), da_append_array(), etc.
+ * @note No-op if capacity is already sufficient
+ * @note Asserts on allocation failure
+ *
+ * @code
+ * if (da_length(arr) + n > da_capacity(arr)) {
+ *     da_grow(arr, da_length(arr) + n);  // amortized growth, like n pushes
+ * }
+ * @endcode
+ */
+DA_DEF void da_grow(da_array arr, da_int_t min_capacity);
+
+/**
+ * @brief Applies the shrink side of the array's growth policy
+ * @param arr Array to check (must not be NULL)
+ * @note Shrinks capacity to max(2 * length, shrink_min_capacity) when length < capacity / shrink_divisor
+ * @note No-op without a policy or with shrink_divisor = 0
+ * @note Called by da_pop(), da_remove(), da_remove_range(), da_clear() and the typed pop/remove
+ */
+DA_DEF void da_auto_shrink(da_array arr);
 
 /**
  * @brief Changes the array length, growing or shrinking as needed
@@ -524,7 +1134,7 @@ DA_DEF void da_reserve(da_array arr, int new_capacity);
  * // Elements old_length..99 are zero-initialized
  * @endcode
  */
-DA_DEF void da_resize(da_array arr, int new_length);
+DA_DEF void da_resize(da_array arr, da_int_t new_length);
 
 /**
  * @brief Reduces the array's allocated capacity to a specific size
@@ -541,7 +1151,7 @@ DA_DEF void da_resize(da_array arr, int new_length);
  * da_trim(arr, 30);  // capacity = 30, saves memory
  * @endcode
  */
-DA_DEF void da_trim(da_array arr, int new_capacity);
+DA_DEF void da_trim(da_array arr, da_int_t new_capacity);
 
 /**
  * @brief Appends all elements from source array to destination array
@@ -594,7 +1204,7 @@ DA_DEF da_array da_concat(da_array arr1, da_array arr2);
  * da_append_raw(arr, raw_data, 4);  // Append all 4 elements at once
  * @endcode
  */
-DA_DEF void da_append_raw(da_array arr, const void* data, int count);
+DA_DEF void da_append_raw(da_array arr, const void* data, da_int_t count);
 
 /**
  * @brief Fills the array with multiple copies of an element
@@ -610,7 +1220,7 @@ DA_DEF void da_append_raw(da_array arr, const void* data, int count);
  * da_fill(arr, &zero, 100);  // Add 100 zeros to array
  * @endcode
  */
-DA_DEF void da_fill(da_array arr, const void* element, int count);
+DA_DEF void da_fill(da_array arr, const void* element, da_int_t count);
 
 /**
  * @brief Creates a new array containing elements from a range [start, end)
@@ -628,7 +1238,7 @@ DA_DEF void da_fill(da_array arr, const void* element, int count);
  * da_array slice = da_slice(original, 1, 4);  // [20, 30, 40]
  * @endcode
  */
-DA_DEF da_array da_slice(da_array arr, int start, int end);
+DA_DEF da_array da_slice(da_array arr, da_int_t start, da_int_t end);
 
 /**
  * @brief Creates a complete copy of an existing array
@@ -739,7 +1349,7 @@ DA_DEF void da_reduce(da_array arr, const void* initial, void* result,
  * da_remove_range(arr, 2, 3);
  * @endcode
  */
-DA_DEF void da_remove_range(da_array arr, int start, int count);
+DA_DEF void da_remove_range(da_array arr, da_int_t start, da_int_t count);
 
 /**
  * @brief Reverses all elements in the array in place
@@ -766,7 +1376,7 @@ DA_DEF void da_reverse(da_array arr);
  * da_swap(arr, 0, 2);  // Swap first and third elements
  * @endcode
  */
-DA_DEF void da_swap(da_array arr, int i, int j);
+DA_DEF void da_swap(da_array arr, da_int_t i, da_int_t j);
 
 /**
  * @brief Checks if the array is empty
@@ -799,7 +1409,7 @@ DA_DEF int da_is_empty(da_array arr);
  * int index = da_find_index(numbers, is_even, NULL);  // returns 2 (index of 4)
  * @endcode
  */
-DA_DEF int da_find_index(da_array arr, int (*predicate)(const void* element, void* context), void* context);
+DA_DEF da_int_t da_find_index(da_array arr, int (*predicate)(const void* element, void* context), void* context);
 
 /**
  * @brief Check if array contains element matching predicate
@@ -845,6 +1455,106 @@ DA_DEF void da_sort(da_array arr, int (*compare)(const void* a, const void* b, v
 
 /** @} */ // end of array_utility group
 
+/**
+ * @defgroup views Array Views
+ * @brief Zero-copy, read-only subranges that share their parent's storage
+ * @{
+ */
+
+/**
+ * @brief Read-only window onto a range of an array
+ * @note A value type: creating one allocates nothing; it holds one reference to its parent
+ * @note Element pointers are computed from the parent on every access, so they follow
+ *       the parent's storage if it grows; the parent must keep at least offset + length elements
+ */
+typedef struct {
+    da_array parent;   /**< @brief Retained array the view points into */
+    da_int_t offset;   /**< @brief Index of the view's first element in the parent */
+    da_int_t length;   /**< @brief Number of elements in the view */
+} da_view_t;
+
+/**
+ * @brief Creates a view of arr[start, end) without copying
+ * @param arr Parent array (must not be NULL); retained until da_view_release()
+ * @param start First index (0 <= start <= length)
+ * @param end One past the last index (start <= end <= length)
+ * @return View holding a reference to arr
+ *
+ * @code
+ * da_view_t word = da_view(tokens, 4, 9);
+ * for (da_int_t i = 0; i < da_view_length(word); i++) {
+ *     handle_token(DA_VIEW_AT(word, i, Token));
+ * }
+ * da_view_release(&word);
+ * @endcode
+ */
+DA_DEF da_view_t da_view(da_array arr, da_int_t start, da_int_t end);
+
+/**
+ * @brief Creates a view of view[start, end), sharing the same parent
+ * @return New view holding its own reference to the parent
+ */
+DA_DEF da_view_t da_view_slice(da_view_t view, da_int_t start, da_int_t end);
+
+/**
+ * @brief Drops the view's reference to its parent
+ * @param view View to release (its parent becomes NULL)
+ */
+DA_DEF void da_view_release(da_view_t* view);
+
+/**
+ * @brief Gets a read-only pointer to an element of a view
+ * @param view View to access
+ * @param index Element index (must be >= 0 and < view length)
+ * @note static inline when DA_INLINE_FASTPATH=1
+ */
+DA_FASTPATH_DEF const void* da_view_get(da_view_t view, da_int_t index);
+
+/**
+ * @brief Gets a read-only pointer to the view's first element (NULL-safe for empty views)
+ * @note Valid until the parent is modified; static inline when DA_INLINE_FASTPATH=1
+ */
+DA_FASTPATH_DEF const void* da_view_data(da_view_t view);
+
+/**
+ * @brief Gets the number of elements in a view
+ * @note static inline when DA_INLINE_FASTPATH=1
+ */
+DA_FASTPATH_DEF da_int_t da_view_length(da_view_t view);
+
+/**
+ * @brief Copies a view into a new array (same as da_slice() on the parent)
+ * @return New array with ref_count = 1, inheriting the parent's retain/release functions
+ */
+DA_DEF da_array da_materialize(da_view_t view);
+
+/**
+ * @brief da_filter() over a view; the result is configured like the parent
+ */
+DA_DEF da_array da_view_filter(da_view_t view, int (*predicate)(const void* element, void* context), void* context);
+
+/**
+ * @brief da_map() over a view; the result is configured like the parent
+ */
+DA_DEF da_array da_view_map(da_view_t view, void (*mapper)(const void* src, void* dst, void* context), void* context);
+
+/**
+ * @brief da_reduce() over a view
+ */
+DA_DEF void da_view_reduce(da_view_t view, const void* initial, void* result,
+                           void (*reducer)(void* accumulator, const void* element, void* context), void* context);
+
+/**
+ * @brief da_find_index() over a view
+ * @return Index within the view, or -1
+ */
+DA_DEF da_int_t da_view_find_index(da_view_t view, int (*predicate)(const void* element, void* context), void* context);
+
+/** @brief Reads element i of a view as type T */
+#define DA_VIEW_AT(view, i, T) (*(const T*)da_view_get(view, i))
+
+/** @} */ // end of views group
+
 /**
  * @defgroup builder_lifecycle Builder Lifecycle
  * @brief Functions for creating and managing ArrayBuffer-style builders
@@ -855,7 +1565,7 @@ DA_DEF void da_sort(da_array arr, int (*compare)(const void* a, const void* b, v
  * @brief Creates a new array builder for efficient construction
  * @param element_size Size in bytes of each element (must be > 0)
  * @return New builder with length = 0 and capacity = 0
- * @note Builders always use doubling growth strategy for fast construction
+ * @note Builders double by default; da_builder_set_growth() attaches another policy
  * @note Not thread-safe
  * @note Use da_builder_to_array() to convert to ref-counted array
  * @note Asserts on allocation failure
@@ -866,13 +1576,43 @@ DA_DEF void da_sort(da_array arr, int (*compare)(const void* a, const void* b, v
  * da_array arr = da_builder_to_array(&builder);
  * @endcode
  */
-DA_DEF da_builder da_builder_create(int element_size);
+DA_DEF da_builder da_builder_create(da_int_t element_size);
 
 /**
- * @brief Converts builder to a ref-counted array with exact capacity
- * @param builder Pointer to builder pointer (will be set to NULL)
- * @param destructor Optional destructor function for the resulting array (NULL if not needed)
- * @return New da_array with capacity = length (no wasted memory)
+ * @brief Creates a new array builder whose memory comes from a custom allocator
+ * @param element_size Size in bytes of each element (must be > 0)
+ * @param allocator Allocator for the builder and its storage (NULL = DA_MALLOC/DA_REALLOC/DA_FREE)
+ * @return New builder with length = 0 and capacity = 0
+ * @note da_builder_to_array() passes the allocator on to the resulting array
+ * @note Asserts on allocation failure
+ *
+ * @code
+ * da_builder builder = da_builder_create_with_allocator(sizeof(int), &frame_allocator);
+ * @endcode
+ */
+DA_DEF da_builder da_builder_create_with_allocator(da_int_t element_size, const da_allocator* allocator);
+
+/**
+ * @brief Sets the alignment of the builder's storage, which da_builder_to_array() passes on
+ * @param builder Builder to modify (must not be NULL)
+ * @param alignment Power of two between 1 and 4096
+ * @note Existing storage is moved to a freshly aligned buffer
+ */
+DA_DEF void da_builder_set_alignment(da_builder builder, int alignment);
+
+/**
+ * @brief Sets the growth policy of the builder, which da_builder_to_array() passes on
+ * @param builder Builder to modify (must not be NULL)
+ * @param policy Policy to use (NULL = doubling)
+ * @note The policy is not copied; it must outlive the builder and the array built from it
+ */
+DA_DEF void da_builder_set_growth(da_builder builder, const da_growth_policy* policy);
+
+/**
+ * @brief Converts builder to a ref-counted array with exact capacity
+ * @param builder Pointer to builder pointer (will be set to NULL)
+ * @param destructor Optional destructor function for the resulting array (NULL if not needed)
+ * @return New da_array with capacity = length (no wasted memory)
  * @note Builder is consumed and *builder is set to NULL
  * @note Resulting array has ref_count = 1
  * @note Memory is reallocated to exact size for efficiency
@@ -928,7 +1668,7 @@ DA_DEF void da_builder_destroy(da_builder* builder);
  * @brief Appends an element to the builder
  * @param builder Builder to modify (must not be NULL)
  * @param element Pointer to element data to copy (must not be NULL)
- * @note Always uses doubling growth strategy for fast construction
+ * @note Doubles by default for fast construction; follows the policy set with da_builder_set_growth()
  * @note Asserts on allocation failure or NULL parameters
  * @note Much faster than da_push() for bulk construction
  *
@@ -947,7 +1687,7 @@ DA_DEF void da_builder_append(da_builder builder, const void* element);
  * @note Only increases capacity, never decreases
  * @note Asserts on allocation failure
  * @note Useful for avoiding multiple reallocations when size is known
- * @note Builders always use doubling growth strategy
+ * @note Later appends grow by the builder's policy (doubling unless set with da_builder_set_growth())
  *
  * @code
  * da_builder builder = DA_BUILDER_CREATE(int);
@@ -957,7 +1697,7 @@ DA_DEF void da_builder_append(da_builder builder, const void* element);
  * }
  * @endcode
  */
-DA_DEF void da_builder_reserve(da_builder builder, int new_capacity);
+DA_DEF void da_builder_reserve(da_builder builder, da_int_t new_capacity);
 
 /**
  * @brief Appends all elements from an array to the builder
@@ -990,14 +1730,14 @@ DA_DEF void da_builder_append_array(da_builder builder, da_array arr);
  * @param builder Builder to query (must not be NULL)
  * @return Number of elements currently in the builder
  */
-DA_DEF int da_builder_length(da_builder builder);
+DA_DEF da_int_t da_builder_length(da_builder builder);
 
 /**
  * @brief Gets the current allocated capacity of the builder
  * @param builder Builder to query (must not be NULL)
  * @return Number of elements that can be stored without reallocation
  */
-DA_DEF int da_builder_capacity(da_builder builder);
+DA_DEF da_int_t da_builder_capacity(da_builder builder);
 
 /**
  * @brief Gets a pointer to an element at the specified index
@@ -1006,7 +1746,7 @@ DA_DEF int da_builder_capacity(da_builder builder);
  * @return Pointer to element at index
  * @note Asserts on out-of-bounds access
  */
-DA_DEF void* da_builder_get(da_builder builder, int index);
+DA_DEF void* da_builder_get(da_builder builder, da_int_t index);
 
 /**
  * @brief Sets the value of an element at the specified index
@@ -1015,1322 +1755,5249 @@ DA_DEF void* da_builder_get(da_builder builder, int index);
  * @param element Pointer to element data to copy (must not be NULL)
  * @note Asserts on out-of-bounds access or NULL parameters
  */
-DA_DEF void da_builder_set(da_builder builder, int index, const void* element);
+DA_DEF void da_builder_set(da_builder builder, da_int_t index, const void* element);
 
 /** @} */ // end of builder_utility group
 
 /**
- * @defgroup array_macros Type-Safe Array Macros
- * @brief Convenient type-safe macros for array operations
+ * @defgroup deque Deque
+ * @brief Ring-buffer queue with O(1) insertion and removal at both ends
  * @{
  */
 
- /**
-  * @def DA_CREATE(T, cap)
-  * @brief Type-safe array creation
-  * @param T Element type (e.g., int, float, struct mytype)
-  * @param cap Initial capacity
-  * @return New da_array sized for type T
-  *
-  * @code
-  * da_array arr = DA_CREATE(int, 10);
-  * @endcode
-  */
+/**
+ * @brief Creates a deque
+ * @param element_size Size in bytes of each element (must be > 0)
+ * @param initial_capacity Initial capacity (0 = allocate on first push)
+ * @param retain_fn Optional function called on every element added (NULL if not needed)
+ * @param release_fn Optional function called on every element removed or destroyed (NULL if not needed)
+ * @return New deque
+ *
+ * @code
+ * da_deque queue = DA_DEQUE_CREATE(Job, 64);
+ * da_deque_push(queue, &job);          // enqueue at the back
+ * da_deque_shift(queue, &next);        // dequeue from the front, O(1)
+ * da_deque_destroy(&queue);
+ * @endcode
+ */
+DA_DEF da_deque da_deque_create(da_int_t element_size, da_int_t initial_capacity, void (*retain_fn)(void*),
+                                void (*release_fn)(void*));
 
- /**
-  * @def DA_PUSH_TYPED(arr, val, T)
-  * @brief Type-safe element append with explicit type parameter
-  * @param arr Array to modify
-  * @param val Value to append
-  * @param T Explicit type of the value
-  * @note Always requires explicit type parameter
-  *
-  * @code
-  * DA_PUSH_TYPED(arr, 42, int);
-  * @endcode
-  */
+/**
+ * @brief Creates a deque whose header and ring buffer come from a custom allocator
+ * @param allocator Allocator (NULL = DA_MALLOC/DA_REALLOC/DA_FREE); must outlive the deque
+ */
+DA_DEF da_deque da_deque_create_with_allocator(da_int_t element_size, da_int_t initial_capacity,
+                                               void (*retain_fn)(void*), void (*release_fn)(void*),
+                                               const da_allocator* allocator);
 
- /**
-  * @def DA_PUT_TYPED(arr, i, val, T)
-  * @brief Type-safe element assignment with explicit type parameter
-  * @param arr Array to modify
-  * @param i Index to set
-  * @param val Value to assign
-  * @param T Explicit type of the value
-  * @note Always requires explicit type parameter
-  *
-  * @code
-  * DA_PUT_TYPED(arr, 0, 42, int);
-  * @endcode
-  */
+/**
+ * @brief Releases every element and frees the deque
+ * @param deque Pointer to deque pointer (will be set to NULL)
+ */
+DA_DEF void da_deque_destroy(da_deque* deque);
 
- /**
-  * @def DA_INSERT_TYPED(arr, i, val, T)
-  * @brief Type-safe element insert with explicit type parameter
-  * @param arr Array to modify
-  * @param i Index to insert at
-  * @param val Value to insert
-  * @param T Explicit type of the value
-  * @note Always requires explicit type parameter
-  *
-  * @code
-  * DA_INSERT_TYPED(arr, 0, 42, int);
-  * @endcode
-  */
+/**
+ * @brief Appends an element at the back (amortized O(1))
+ */
+DA_DEF void da_deque_push(da_deque deque, const void* element);
 
- /**
-  * @def DA_PUSH_INFERRED(arr, val)
-  * @brief Type-safe element append with automatic type inference
-  * @param arr Array to modify
-  * @param val Value to append
-  * @note Only available when DA_SUPPORT_TYPE_INFERENCE=1
-  * @note Automatically infers type using typeof or auto
-  *
-  * @code
-  * DA_PUSH_INFERRED(arr, 42);  // Type inferred as int
-  * @endcode
-  */
+/**
+ * @brief Removes the element at the back
+ * @param out Optional pointer receiving a copy of the element (can be NULL)
+ */
+DA_DEF void da_deque_pop(da_deque deque, void* out);
 
- /**
-  * @def DA_PUT_INFERRED(arr, i, val)
-  * @brief Type-safe element assignment with automatic type inference
-  * @param arr Array to modify
-  * @param i Index to set
-  * @param val Value to assign
-  * @note Only available when DA_SUPPORT_TYPE_INFERENCE=1
-  * @note Automatically infers type using typeof or auto
-  *
-  * @code
-  * DA_PUT_INFERRED(arr, 0, 42);  // Type inferred as int
-  * @endcode
-  */
+/**
+ * @brief Inserts an element at the front (amortized O(1))
+ */
+DA_DEF void da_deque_unshift(da_deque deque, const void* element);
 
- /**
-  * @def DA_INSERT_INFERRED(arr, i, val)
-  * @brief Type-safe element insert with automatic type inference
-  * @param arr Array to modify
-  * @param i Index to insert at
-  * @param val Value to insert
-  * @note Only available when DA_SUPPORT_TYPE_INFERENCE=1
-  * @note Automatically infers type using typeof or auto
-  *
-  * @code
-  * DA_INSERT_INFERRED(arr, 0, 42);  // Type inferred as int
-  * @endcode
-  */
+/**
+ * @brief Removes the element at the front in O(1)
+ * @param out Optional pointer receiving a copy of the element (can be NULL)
+ */
+DA_DEF void da_deque_shift(da_deque deque, void* out);
 
- /**
-  * @def DA_PUSH(arr, val) or DA_PUSH(arr, val, T)
-  * @brief Type-safe element append (adaptive macro)
-  * @param arr Array to modify
-  * @param val Value to append
-  * @param T Type parameter (only when DA_SUPPORT_TYPE_INFERENCE=0 or DA_NOT_USE_TYPE_GENERIC is defined)
-  * @note When DA_SUPPORT_TYPE_INFERENCE=1 and DA_NOT_USE_TYPE_GENERIC is not defined: DA_PUSH(arr, 42)
-  * @note When DA_SUPPORT_TYPE_INFERENCE=0 or DA_NOT_USE_TYPE_GENERIC is defined: DA_PUSH(arr, 42, int)
-  * @note Automatically chooses between inferred and typed versions
-  *
-  * @code
-  * // With type inference support:
-  * DA_PUSH(arr, 42);
-  *
-  * // Without type inference or with DA_NOT_USE_TYPE_GENERIC:
-  * DA_PUSH(arr, 42, int);
-  * @endcode
-  */
+/**
+ * @brief Gets a pointer to element index, counted from the front
+ * @note Valid until the deque is modified
+ */
+DA_DEF void* da_deque_get(da_deque deque, da_int_t index);
 
- /**
-  * @def DA_PUT(arr, i, val) or DA_PUT(arr, i, val, T)
-  * @brief Type-safe element assignment (adaptive macro)
-  * @param arr Array to modify
-  * @param i Index to set
-  * @param val Value to assign
-  * @param T Type parameter (only when DA_SUPPORT_TYPE_INFERENCE=0 or DA_NOT_USE_TYPE_GENERIC is defined)
-  * @note When DA_SUPPORT_TYPE_INFERENCE=1 and DA_NOT_USE_TYPE_GENERIC is not defined: DA_PUT(arr, 0, 42)
-  * @note When DA_SUPPORT_TYPE_INFERENCE=0 or DA_NOT_USE_TYPE_GENERIC is defined: DA_PUT(arr, 0, 42, int)
-  * @note Automatically chooses between inferred and typed versions
-  *
-  * @code
-  * // With type inference support:
-  * DA_PUT(arr, 0, 42);
-  *
-  * // Without type inference or with DA_NOT_USE_TYPE_GENERIC:
-  * DA_PUT(arr, 0, 42, int);
-  * @endcode
-  */
+/**
+ * @brief Gets a pointer to the first element (must not be empty)
+ */
+DA_DEF void* da_deque_peek_first(da_deque deque);
 
- /**
-  * @def DA_INSERT(arr, i, val) or DA_INSERT(arr, i, val, T)
-  * @brief Type-safe element insert (adaptive macro)
-  * @param arr Array to modify
-  * @param i Index to insert at
-  * @param val Value to insert
-  * @param T Type parameter (only when DA_SUPPORT_TYPE_INFERENCE=0 or DA_NOT_USE_TYPE_GENERIC is defined)
-  * @note When DA_SUPPORT_TYPE_INFERENCE=1 and DA_NOT_USE_TYPE_GENERIC is not defined: DA_INSERT(arr, 0, 42)
-  * @note When DA_SUPPORT_TYPE_INFERENCE=0 or DA_NOT_USE_TYPE_GENERIC is defined: DA_INSERT(arr, 0, 42, int)
-  * @note Automatically chooses between inferred and typed versions
-  *
-  * @code
-  * // With type inference support:
-  * DA_INSERT(arr, 0, 42);
-  *
-  * // Without type inference or with DA_NOT_USE_TYPE_GENERIC:
-  * DA_INSERT(arr, 0, 42, int);
-  * @endcode
-  */
+/**
+ * @brief Gets a pointer to the last element (must not be empty)
+ */
+DA_DEF void* da_deque_peek(da_deque deque);
 
 /**
- * @def DA_AT(arr, i, T)
- * @brief Type-safe element access by value
- * @param arr Array to access
- * @param i Index to get
- * @param T Element type
- * @return Element value at index i
+ * @brief Gets the number of elements
+ */
+DA_DEF da_int_t da_deque_length(da_deque deque);
+
+/**
+ * @brief Gets the allocated capacity
+ */
+DA_DEF da_int_t da_deque_capacity(da_deque deque);
+
+/**
+ * @brief Ensures room for at least new_capacity elements
+ */
+DA_DEF void da_deque_reserve(da_deque deque, da_int_t new_capacity);
+
+/**
+ * @brief Releases every element; capacity is kept
+ */
+DA_DEF void da_deque_clear(da_deque deque);
+
+/**
+ * @brief Moves the elements into one contiguous run, front first
+ * @return Pointer to the first element (NULL when empty); elements are at [0, length) from it
+ * @note O(1) when the elements do not wrap around; otherwise O(length), in place when the
+ *       free slots can hold the wrapped part, else through a fresh buffer
+ */
+DA_DEF void* da_deque_linearize(da_deque deque);
+
+#define DA_DEQUE_CREATE(T, cap) da_deque_create(sizeof(T), cap, NULL, NULL)
+#define DA_DEQUE_AT(deque, i, T) (*(T*)da_deque_get(deque, i))
+
+/** @} */ // end of deque group
+
+/**
+ * @defgroup segmented Segmented Arrays
+ * @brief Arrays whose element pointers stay valid while they grow
+ * @{
+ */
+
+/**
+ * @brief Creates an empty segmented array
+ * @param element_size Size in bytes of each element (must be > 0)
+ * @param first_chunk Elements in the first chunk, rounded up to a power of two (0 = 16)
+ * @param retain_fn Optional function called on every element added (NULL if not needed)
+ * @param release_fn Optional function called on every element removed or destroyed (NULL if not needed)
+ * @return New segmented array
+ * @note Pushing never moves existing elements: pointers from da_segmented_get() stay
+ *       valid until that element is popped or the array is cleared or destroyed
  *
  * @code
- * int value = DA_AT(arr, 0, int);
+ * da_segmented objects = DA_SEGMENTED_CREATE(Object, 0);
+ * Object* obj = da_segmented_push(objects, &init);  // stable for the object's lifetime
+ * da_segmented_destroy(&objects);
  * @endcode
  */
+DA_DEF da_segmented da_segmented_create(da_int_t element_size, da_int_t first_chunk, void (*retain_fn)(void*),
+                                        void (*release_fn)(void*));
 
 /**
- * @def DA_LENGTH(arr)
- * @brief Get array length (shorthand for da_length)
+ * @brief Creates a segmented array whose header and chunks come from a custom allocator
+ * @param allocator Allocator (NULL = DA_MALLOC/DA_REALLOC/DA_FREE); must outlive the array
  */
+DA_DEF da_segmented da_segmented_create_with_allocator(da_int_t element_size, da_int_t first_chunk,
+                                                       void (*retain_fn)(void*), void (*release_fn)(void*),
+                                                       const da_allocator* allocator);
 
 /**
- * @def DA_CAPACITY(arr)
- * @brief Get array capacity (shorthand for da_capacity)
+ * @brief Releases every element and frees all chunks and the header
+ * @param seg Pointer to segmented array pointer (will be set to NULL)
  */
+DA_DEF void da_segmented_destroy(da_segmented* seg);
 
 /**
- * @def DA_POP(arr, out_ptr)
- * @brief Pop last element (shorthand for da_pop)
+ * @brief Appends an element, allocating a new chunk when the last one is full
+ * @return Address of the stored element; it does not change when the array grows
  */
+DA_DEF void* da_segmented_push(da_segmented seg, const void* element);
 
 /**
- * @def DA_CLEAR(arr)
- * @brief Clear array (shorthand for da_clear)
+ * @brief Removes the last element
+ * @param out Optional pointer receiving a copy of the element (can be NULL)
+ * @note Chunks are kept for reuse; da_segmented_trim() frees the empty ones
  */
+DA_DEF void da_segmented_pop(da_segmented seg, void* out);
 
 /**
- * @def DA_RESERVE(arr, cap)
- * @brief Reserve capacity (shorthand for da_reserve)
+ * @brief Gets a pointer to element index in O(1)
  */
+DA_DEF void* da_segmented_get(da_segmented seg, da_int_t index);
 
 /**
- * @def DA_RESIZE(arr, len)
- * @brief Resize array (shorthand for da_resize)
+ * @brief Gets a pointer to the last element (must not be empty)
  */
+DA_DEF void* da_segmented_peek(da_segmented seg);
 
 /**
- * @def DA_INSERT(arr, i, val)
- * @brief Type-safe element insert (with typeof support)
- * @param arr Array to modify
- * @param i Index to insert at
- * @param val Value to insert
- * @note With typeof support: DA_INSERT(arr, 0, 42)
- * @note Without typeof: DA_INSERT(arr, 0, 42, int)
+ * @brief Gets the number of elements
  */
+DA_DEF da_int_t da_segmented_length(da_segmented seg);
 
 /**
- * @def DA_REMOVE(arr, i, out_ptr)
- * @brief Remove element at index (shorthand for da_remove)
- * @param arr Array to modify
- * @param i Index to remove from
- * @param out_ptr Optional pointer to store removed element (can be NULL)
+ * @brief Gets the number of elements the allocated chunks can hold
  */
+DA_DEF da_int_t da_segmented_capacity(da_segmented seg);
 
-/** @} */ // end of array_macros group
+/**
+ * @brief Allocates chunks until at least new_capacity elements fit
+ */
+DA_DEF void da_segmented_reserve(da_segmented seg, da_int_t new_capacity);
 
-#define DA_NEW(T) da_new(sizeof(T))
-#define DA_CREATE(T, cap, retain_fn, release_fn) da_create(sizeof(T), cap, retain_fn, release_fn)
+/**
+ * @brief Frees the chunks that hold no elements
+ */
+DA_DEF void da_segmented_trim(da_segmented seg);
 
-#define DA_PUSH_TYPED(arr, val, T) do { T _temp = (val); da_push(arr, (void*)&_temp); } while(0)
-#define DA_PUT_TYPED(arr, i, val, T) do { T _temp = (val); da_set(arr, i, (void*)&_temp); } while(0)
-#define DA_INSERT_TYPED(arr, i, val, T) do { T _temp = (val); da_insert(arr, i, (void*)&_temp); } while(0)
+/**
+ * @brief Releases every element; chunks are kept
+ */
+DA_DEF void da_segmented_clear(da_segmented seg);
 
-#if DA_SUPPORT_TYPE_INFERENCE
-    #define DA_PUSH_INFERRED(arr, val) do { DA_MAKE_VAR_WITH_INFERRED_TYPE(_temp, val); da_push(arr, (void*)&_temp); } while(0)
-    #define DA_PUT_INFERRED(arr, i, val) do { DA_MAKE_VAR_WITH_INFERRED_TYPE(_temp, val); da_set(arr, i, (void*)&_temp); } while(0)
-    #define DA_INSERT_INFERRED(arr, i, val) do { DA_MAKE_VAR_WITH_INFERRED_TYPE(_temp, val); da_insert(arr, i, (void*)&_temp); } while(0)
-#endif
+/**
+ * @brief Copies every element into contiguous memory, one memcpy per chunk
+ * @param dest Buffer of at least length * element_size bytes
+ * @note Raw byte copy: retain_fn is not called
+ */
+DA_DEF void da_segmented_export(da_segmented seg, void* dest);
 
-#if DA_SUPPORT_TYPE_INFERENCE && !defined(DA_NOT_USE_TYPE_GENERIC)
-    #define DA_PUSH(arr, val) DA_PUSH_INFERRED(arr, val)
-    #define DA_PUT(arr, i, val) DA_PUT_INFERRED(arr, i, val)
-    #define DA_INSERT(arr, i, val) DA_INSERT_INFERRED(arr, i, val)
-#else
-    #define DA_PUSH(arr, val, T) DA_PUSH_TYPED(arr, val, T)
-    #define DA_PUT(arr, i, val, T) DA_PUT_TYPED(arr, i, val, T)
-    #define DA_INSERT(arr, i, val, T) DA_INSERT_TYPED(arr, i, val, T)
-#endif
+/**
+ * @brief Creates a da_array sized for every element and copies them in order
+ * @return New array with the same retain/release functions and allocator; elements are retained
+ */
+DA_DEF da_array da_segmented_to_array(da_segmented seg);
 
-#define DA_LENGTH(arr) da_length(arr)
-#define DA_CAPACITY(arr) da_capacity(arr)
-#define DA_AT(arr, i, T) (*(T*)da_get(arr, i))
-#define DA_POP(arr, out_ptr) da_pop(arr, out_ptr)
-#define DA_REMOVE(arr, i, out_ptr) da_remove(arr, i, out_ptr)
-#define DA_CLEAR(arr) da_clear(arr)
-#define DA_RESERVE(arr, cap) da_reserve(arr, cap)
-#define DA_RESIZE(arr, len) da_resize(arr, len)
-#define DA_TRIM(arr, cap) da_trim(arr, cap)
-#define DA_SHRINK_TO_FIT(arr) da_trim(arr, da_length(arr))
-#define DA_PEEK(arr, T) (*(T*)da_peek(arr))
-#define DA_PEEK_FIRST(arr, T) (*(T*)da_peek_first(arr))
+#define DA_SEGMENTED_CREATE(T, first_chunk) da_segmented_create(sizeof(T), first_chunk, NULL, NULL)
+#define DA_SEGMENTED_AT(seg, i, T) (*(T*)da_segmented_get(seg, i))
+
+/** @} */ // end of segmented group
 
 /**
- * @defgroup builder_macros Type-Safe Builder Macros
- * @brief Convenient type-safe macros for builder operations
+ * @defgroup gap Gap Buffers
+ * @brief Arrays for insert- and remove-heavy editing around a cursor
+ * @{
+ */
+
+/**
+ * @brief Creates an empty gap buffer
+ * @param element_size Size in bytes of each element (must be > 0)
+ * @param initial_capacity Initial capacity (0 = allocate on first insert)
+ * @param retain_fn Optional function called on every element added (NULL if not needed)
+ * @param release_fn Optional function called on every element removed or destroyed (NULL if not needed)
+ * @return New gap buffer
+ * @note An insert or remove at index costs O(distance from the previous edit) instead of
+ *       O(length - index) as with da_insert()/da_remove()
+ *
+ * @code
+ * da_gap text = DA_GAP_CREATE(char, 4096);
+ * da_gap_insert(text, cursor++, &ch);   // typing: the gap follows the cursor
+ * da_gap_remove(text, --cursor, NULL);  // backspace
+ * da_array flat = da_gap_to_array(text);
+ * da_gap_destroy(&text);
+ * @endcode
+ */
+DA_DEF da_gap da_gap_create(da_int_t element_size, da_int_t initial_capacity, void (*retain_fn)(void*),
+                            void (*release_fn)(void*));
+
+/**
+ * @brief Creates a gap buffer whose header and elements come from a custom allocator
+ * @param allocator Allocator (NULL = DA_MALLOC/DA_REALLOC/DA_FREE); must outlive the gap buffer
+ */
+DA_DEF da_gap da_gap_create_with_allocator(da_int_t element_size, da_int_t initial_capacity,
+                                           void (*retain_fn)(void*), void (*release_fn)(void*),
+                                           const da_allocator* allocator);
+
+/**
+ * @brief Releases every element and frees the gap buffer
+ * @param gap Pointer to gap buffer pointer (will be set to NULL)
+ */
+DA_DEF void da_gap_destroy(da_gap* gap);
+
+/**
+ * @brief Inserts an element at index (must be >= 0 and <= length)
+ * @note Moves the gap to index first; amortized O(1) when index is at or next to the previous edit
+ */
+DA_DEF void da_gap_insert(da_gap gap, da_int_t index, const void* element);
+
+/**
+ * @brief Inserts count elements from a raw C array at index
+ */
+DA_DEF void da_gap_insert_raw(da_gap gap, da_int_t index, const void* data, da_int_t count);
+
+/**
+ * @brief Removes the element at index (must be >= 0 and < length)
+ * @param out Optional pointer receiving a copy of the element (can be NULL)
+ * @note Moves the gap to index first; O(1) when index is at or just before the previous edit
+ */
+DA_DEF void da_gap_remove(da_gap gap, da_int_t index, void* out);
+
+/**
+ * @brief Removes count elements starting at start
+ */
+DA_DEF void da_gap_remove_range(da_gap gap, da_int_t start, da_int_t count);
+
+/**
+ * @brief Appends an element at the end
+ */
+DA_DEF void da_gap_push(da_gap gap, const void* element);
+
+/**
+ * @brief Gets a pointer to element index
+ * @note Valid until the gap buffer is modified
+ */
+DA_DEF void* da_gap_get(da_gap gap, da_int_t index);
+
+/**
+ * @brief Replaces element index, releasing the old value and retaining the new one
+ */
+DA_DEF void da_gap_set(da_gap gap, da_int_t index, const void* element);
+
+/**
+ * @brief Gets the number of elements
+ */
+DA_DEF da_int_t da_gap_length(da_gap gap);
+
+/**
+ * @brief Gets the allocated capacity
+ */
+DA_DEF da_int_t da_gap_capacity(da_gap gap);
+
+/**
+ * @brief Ensures room for at least new_capacity elements
+ */
+DA_DEF void da_gap_reserve(da_gap gap, da_int_t new_capacity);
+
+/**
+ * @brief Releases every element; capacity is kept
+ */
+DA_DEF void da_gap_clear(da_gap gap);
+
+/**
+ * @brief Creates a da_array holding copies of every element, in order
+ * @return New array with the same retain/release functions and allocator; elements are retained
+ * @note Two memcpy calls: the part before the gap and the part after it
+ */
+DA_DEF da_array da_gap_to_array(da_gap gap);
+
+#define DA_GAP_CREATE(T, cap) da_gap_create(sizeof(T), cap, NULL, NULL)
+#define DA_GAP_AT(gap, i, T) (*(T*)da_gap_get(gap, i))
+
+/** @} */ // end of gap group
+
+/**
+ * @defgroup bigarray Big Arrays
+ * @brief Sequences for random-position inserts and removes at scale
+ * @{
+ */
+
+/**
+ * @brief Creates an empty big array
+ * @param element_size Size in bytes of each element (must be > 0)
+ * @param retain_fn Optional function called on every element added (NULL if not needed)
+ * @param release_fn Optional function called on every element removed or destroyed (NULL if not needed)
+ * @return New big array
+ * @note da_insert()/da_remove() memmove O(n) elements; here they touch one leaf and
+ *       O(log n) branch counts. Edits break even with a flat array around one leaf's
+ *       worth of elements; random reads are up to ten times slower (see bench_bigarray)
+ *
+ * @code
+ * da_bigarray rows = DA_BIGARRAY_CREATE(Row);
+ * da_bigarray_insert(rows, 500000, &row);
+ * da_int_t n;
+ * for (da_int_t i = 0; i < da_bigarray_length(rows); i += n) {
+ *     Row* run = da_bigarray_span(rows, i, &n);  // n contiguous rows from i
+ *     scan(run, n);
+ * }
+ * da_bigarray_destroy(&rows);
+ * @endcode
+ */
+DA_DEF da_bigarray da_bigarray_create(da_int_t element_size, void (*retain_fn)(void*), void (*release_fn)(void*));
+
+/**
+ * @brief Creates a big array whose header and nodes come from a custom allocator
+ * @param allocator Allocator (NULL = DA_MALLOC/DA_REALLOC/DA_FREE); must outlive the big array
+ */
+DA_DEF da_bigarray da_bigarray_create_with_allocator(da_int_t element_size, void (*retain_fn)(void*),
+                                                     void (*release_fn)(void*), const da_allocator* allocator);
+
+/**
+ * @brief Releases every element and frees all nodes and the header
+ * @param big Pointer to big array pointer (will be set to NULL)
+ */
+DA_DEF void da_bigarray_destroy(da_bigarray* big);
+
+/**
+ * @brief Inserts an element at index (must be >= 0 and <= length) in O(log n)
+ */
+DA_DEF void da_bigarray_insert(da_bigarray big, da_int_t index, const void* element);
+
+/**
+ * @brief Appends an element at the end
+ * @note Appending fills leaves completely instead of splitting them in half
+ */
+DA_DEF void da_bigarray_push(da_bigarray big, const void* element);
+
+/**
+ * @brief Removes the element at index (must be >= 0 and < length) in O(log n)
+ * @param out Optional pointer receiving a copy of the element (can be NULL)
+ */
+DA_DEF void da_bigarray_remove(da_bigarray big, da_int_t index, void* out);
+
+/**
+ * @brief Removes count elements starting at start, one leaf at a time
+ */
+DA_DEF void da_bigarray_remove_range(da_bigarray big, da_int_t start, da_int_t count);
+
+/**
+ * @brief Removes the last element
+ * @param out Optional pointer receiving a copy of the element (can be NULL)
+ */
+DA_DEF void da_bigarray_pop(da_bigarray big, void* out);
+
+/**
+ * @brief Gets a pointer to element index in O(log n)
+ * @note Valid until the big array is modified
+ */
+DA_DEF void* da_bigarray_get(da_bigarray big, da_int_t index);
+
+/**
+ * @brief Replaces element index, releasing the old value and retaining the new one
+ */
+DA_DEF void da_bigarray_set(da_bigarray big, da_int_t index, const void* element);
+
+/**
+ * @brief Gets the run of contiguous elements that starts at index
+ * @param available Receives the number of elements in the run (at least 1)
+ * @return Pointer to element index; elements [index, index + *available) follow it
+ * @note Scanning span by span costs one O(log n) lookup per leaf instead of per element
+ */
+DA_DEF void* da_bigarray_span(da_bigarray big, da_int_t index, da_int_t* available);
+
+/**
+ * @brief Gets the number of elements
+ */
+DA_DEF da_int_t da_bigarray_length(da_bigarray big);
+
+/**
+ * @brief Releases every element and frees every node
+ */
+DA_DEF void da_bigarray_clear(da_bigarray big);
+
+/**
+ * @brief Copies every element into contiguous memory, one memcpy per leaf
+ * @param dest Buffer of at least length * element_size bytes
+ * @note Raw byte copy: retain_fn is not called
+ */
+DA_DEF void da_bigarray_export(da_bigarray big, void* dest);
+
+/**
+ * @brief Creates a da_array holding copies of every element, in order
+ * @return New array with the same retain/release functions and allocator; elements are retained
+ */
+DA_DEF da_array da_bigarray_to_array(da_bigarray big);
+
+#define DA_BIGARRAY_CREATE(T) da_bigarray_create(sizeof(T), NULL, NULL)
+#define DA_BIGARRAY_AT(big, i, T) (*(T*)da_bigarray_get(big, i))
+
+/** @} */ // end of bigarray group
+
+/**
+ * @defgroup pvec Persistent Vectors
+ * @brief Immutable vectors whose modified versions share structure
+ * @{
+ */
+
+/**
+ * @brief Creates an empty persistent vector
+ * @param element_size Size in bytes of each element (must be > 0)
+ * @param retain_fn Optional function called once per element per node that stores it (NULL if not needed)
+ * @param release_fn Optional function called when such a node is freed (NULL if not needed)
+ * @return New empty vector with ref_count = 1
+ * @note da_pvec_set/push/pop return a new version and leave the original unchanged; they copy
+ *       O(log32 n) nodes of at most 32 entries instead of the whole vector
+ *
+ * @code
+ * da_pvec v1 = da_pvec_from_array(values);
+ * da_pvec v2 = da_pvec_set(v1, 1000, &x);  // v1 still sees the old value
+ * da_pvec_release(&v1);
+ * da_pvec_release(&v2);
+ * @endcode
+ */
+DA_DEF da_pvec da_pvec_create(da_int_t element_size, void (*retain_fn)(void*), void (*release_fn)(void*));
+
+/**
+ * @brief Creates an empty persistent vector whose headers and nodes come from a custom allocator
+ * @param allocator Allocator (NULL = DA_MALLOC/DA_REALLOC/DA_FREE); must outlive every version
+ */
+DA_DEF da_pvec da_pvec_create_with_allocator(da_int_t element_size, void (*retain_fn)(void*),
+                                             void (*release_fn)(void*), const da_allocator* allocator);
+
+/**
+ * @brief Builds a vector holding the elements of arr, with its retain/release functions and allocator
+ * @note Fills 32-element leaves directly: O(n) element copies
+ */
+DA_DEF da_pvec da_pvec_from_array(da_array arr);
+
+/**
+ * @brief Copies the elements into a new da_array (elements are retained)
+ */
+DA_DEF da_array da_pvec_to_array(da_pvec pvec);
+
+/**
+ * @brief Increments the reference count of a version
+ * @return The same version
+ */
+DA_DEF da_pvec da_pvec_retain(da_pvec pvec);
+
+/**
+ * @brief Decrements the reference count; the last release drops the version's nodes
+ * @param pvec Pointer to version pointer (will be set to NULL)
+ * @note Nodes shared with other versions stay alive
+ */
+DA_DEF void da_pvec_release(da_pvec* pvec);
+
+/**
+ * @brief Returns a new version with element index replaced in O(log32 n)
+ */
+DA_DEF da_pvec da_pvec_set(da_pvec pvec, da_int_t index, const void* element);
+
+/**
+ * @brief Returns a new version with element appended in O(log32 n)
+ */
+DA_DEF da_pvec da_pvec_push(da_pvec pvec, const void* element);
+
+/**
+ * @brief Returns a new version without the last element in O(log32 n)
+ * @param out Optional pointer receiving a copy of the removed element (can be NULL)
+ */
+DA_DEF da_pvec da_pvec_pop(da_pvec pvec, void* out);
+
+/**
+ * @brief Gets a read-only pointer to element index in O(log32 n)
+ * @note Valid while this version is alive
+ */
+DA_DEF const void* da_pvec_get(da_pvec pvec, da_int_t index);
+
+/**
+ * @brief Gets the number of elements
+ */
+DA_DEF da_int_t da_pvec_length(da_pvec pvec);
+
+#define DA_PVEC_CREATE(T) da_pvec_create(sizeof(T), NULL, NULL)
+#define DA_PVEC_AT(pvec, i, T) (*(const T*)da_pvec_get(pvec, i))
+
+/** @} */ // end of pvec group
+
+/**
+ * @defgroup rope Ropes
+ * @brief O(1) concatenation with flattening on demand
+ * @{
+ */
+
+/**
+ * @brief Wraps an array as a rope leaf in O(1)
+ * @param arr Array to wrap (retained; must not be modified while the rope holds it)
+ * @return New rope with ref_count = 1
+ *
+ * @code
+ * da_rope all = da_rope_from_array(first);
+ * for (int i = 0; i < batch_count; i++) {
+ *     da_rope next = da_rope_append(all, batches[i]);  // O(1), nothing copied
+ *     da_rope_release(&all);
+ *     all = next;
+ * }
+ * da_rope_for_each_chunk(all, consume, NULL);  // streams the batches, still nothing copied
+ * const int* flat = da_rope_data(all);         // flattens once, then cached
+ * da_rope_release(&all);
+ * @endcode
+ */
+DA_DEF da_rope da_rope_from_array(da_array arr);
+
+/**
+ * @brief Concatenates two ropes in O(1)
+ * @return New rope retaining both operands; element sizes must match
+ * @note Unlike da_concat(), nothing is allocated for the elements or copied until the
+ *       result is flattened, so a chain of n concatenations costs O(n) instead of O(n^2)
+ */
+DA_DEF da_rope da_rope_concat(da_rope left, da_rope right);
+
+/**
+ * @brief Concatenates a rope and an array in O(1) (shorthand for da_rope_concat with a new leaf)
+ */
+DA_DEF da_rope da_rope_append(da_rope rope, da_array arr);
+
+/**
+ * @brief Increments the reference count of a rope
+ * @return The same rope
+ */
+DA_DEF da_rope da_rope_retain(da_rope rope);
+
+/**
+ * @brief Decrements the reference count; the last release drops the rope's operands and arrays
+ * @param rope Pointer to rope pointer (will be set to NULL)
+ * @note Iterative: deep chains of concatenations do not recurse
+ */
+DA_DEF void da_rope_release(da_rope* rope);
+
+/**
+ * @brief Gets the number of elements in O(1)
+ */
+DA_DEF da_int_t da_rope_length(da_rope rope);
+
+/**
+ * @brief Calls fn once per non-empty leaf array, in order, without flattening
+ * @param fn Receives (chunk_data, chunk_length, context)
+ */
+DA_DEF void da_rope_for_each_chunk(da_rope rope, void (*fn)(const void* data, da_int_t count, void* context),
+                                   void* context);
+
+/**
+ * @brief Gets a pointer to element index, flattening the rope on first use
+ * @note The first call on a concatenation is O(n); later calls are O(1)
+ */
+DA_DEF const void* da_rope_get(da_rope rope, da_int_t index);
+
+/**
+ * @brief Gets a pointer to the contiguous elements, flattening the rope on first use
+ */
+DA_DEF const void* da_rope_data(da_rope rope);
+
+/**
+ * @brief Flattens the rope and returns its array, retained
+ * @note The array is shared with the rope: treat it as read-only, or da_copy() it before mutating
+ */
+DA_DEF da_array da_rope_to_array(da_rope rope);
+
+#define DA_ROPE_AT(rope, i, T) (*(const T*)da_rope_get(rope, i))
+
+/** @} */ // end of rope group
+
+/**
+ * @defgroup array_macros Type-Safe Array Macros
+ * @brief Convenient type-safe macros for array operations
  * @{
  */
 
  /**
-  * @def DA_BUILDER_CREATE(T)
-  * @brief Type-safe builder creation
+  * @def DA_CREATE(T, cap)
+  * @brief Type-safe array creation
   * @param T Element type (e.g., int, float, struct mytype)
-  * @return New da_builder sized for type T
+  * @param cap Initial capacity
+  * @return New da_array sized for type T
   *
   * @code
-  * da_builder builder = DA_BUILDER_CREATE(int);
+  * da_array arr = DA_CREATE(int, 10);
   * @endcode
   */
 
  /**
-  * @def DA_BUILDER_APPEND_TYPED(builder, val, T)
-  * @brief Type-safe element append to builder with explicit type parameter
-  * @param builder Builder to modify
+  * @def DA_PUSH_TYPED(arr, val, T)
+  * @brief Type-safe element append with explicit type parameter
+  * @param arr Array to modify
   * @param val Value to append
   * @param T Explicit type of the value
   * @note Always requires explicit type parameter
   *
   * @code
-  * DA_BUILDER_APPEND_TYPED(builder, 42, int);
+  * DA_PUSH_TYPED(arr, 42, int);
   * @endcode
   */
 
  /**
-  * @def DA_BUILDER_PUT_TYPED(builder, i, val, T)
-  * @brief Type-safe element assignment in builder with explicit type parameter
-  * @param builder Builder to modify
+  * @def DA_PUT_TYPED(arr, i, val, T)
+  * @brief Type-safe element assignment with explicit type parameter
+  * @param arr Array to modify
   * @param i Index to set
   * @param val Value to assign
   * @param T Explicit type of the value
   * @note Always requires explicit type parameter
   *
   * @code
-  * DA_BUILDER_PUT_TYPED(builder, 0, 42, int);
+  * DA_PUT_TYPED(arr, 0, 42, int);
   * @endcode
   */
 
  /**
-  * @def DA_BUILDER_APPEND_INFERRED(builder, val)
-  * @brief Type-safe element append to builder with automatic type inference
-  * @param builder Builder to modify
+  * @def DA_INSERT_TYPED(arr, i, val, T)
+  * @brief Type-safe element insert with explicit type parameter
+  * @param arr Array to modify
+  * @param i Index to insert at
+  * @param val Value to insert
+  * @param T Explicit type of the value
+  * @note Always requires explicit type parameter
+  *
+  * @code
+  * DA_INSERT_TYPED(arr, 0, 42, int);
+  * @endcode
+  */
+
+ /**
+  * @def DA_PUSH_INFERRED(arr, val)
+  * @brief Type-safe element append with automatic type inference
+  * @param arr Array to modify
   * @param val Value to append
   * @note Only available when DA_SUPPORT_TYPE_INFERENCE=1
   * @note Automatically infers type using typeof or auto
   *
   * @code
-  * DA_BUILDER_APPEND_INFERRED(builder, 42);  // Type inferred as int
+  * DA_PUSH_INFERRED(arr, 42);  // Type inferred as int
   * @endcode
   */
 
  /**
-  * @def DA_BUILDER_PUT_INFERRED(builder, i, val)
-  * @brief Type-safe element assignment in builder with automatic type inference
-  * @param builder Builder to modify
+  * @def DA_PUT_INFERRED(arr, i, val)
+  * @brief Type-safe element assignment with automatic type inference
+  * @param arr Array to modify
   * @param i Index to set
   * @param val Value to assign
   * @note Only available when DA_SUPPORT_TYPE_INFERENCE=1
   * @note Automatically infers type using typeof or auto
   *
   * @code
-  * DA_BUILDER_PUT_INFERRED(builder, 0, 42);  // Type inferred as int
+  * DA_PUT_INFERRED(arr, 0, 42);  // Type inferred as int
   * @endcode
   */
 
  /**
-  * @def DA_BUILDER_APPEND(builder, val) or DA_BUILDER_APPEND(builder, val, T)
-  * @brief Type-safe element append to builder (adaptive macro)
-  * @param builder Builder to modify
+  * @def DA_INSERT_INFERRED(arr, i, val)
+  * @brief Type-safe element insert with automatic type inference
+  * @param arr Array to modify
+  * @param i Index to insert at
+  * @param val Value to insert
+  * @note Only available when DA_SUPPORT_TYPE_INFERENCE=1
+  * @note Automatically infers type using typeof or auto
+  *
+  * @code
+  * DA_INSERT_INFERRED(arr, 0, 42);  // Type inferred as int
+  * @endcode
+  */
+
+ /**
+  * @def DA_PUSH(arr, val) or DA_PUSH(arr, val, T)
+  * @brief Type-safe element append (adaptive macro)
+  * @param arr Array to modify
   * @param val Value to append
   * @param T Type parameter (only when DA_SUPPORT_TYPE_INFERENCE=0 or DA_NOT_USE_TYPE_GENERIC is defined)
-  * @note When DA_SUPPORT_TYPE_INFERENCE=1 and DA_NOT_USE_TYPE_GENERIC is not defined: DA_BUILDER_APPEND(builder, 42)
-  * @note When DA_SUPPORT_TYPE_INFERENCE=0 or DA_NOT_USE_TYPE_GENERIC is defined: DA_BUILDER_APPEND(builder, 42, int)
+  * @note When DA_SUPPORT_TYPE_INFERENCE=1 and DA_NOT_USE_TYPE_GENERIC is not defined: DA_PUSH(arr, 42)
+  * @note When DA_SUPPORT_TYPE_INFERENCE=0 or DA_NOT_USE_TYPE_GENERIC is defined: DA_PUSH(arr, 42, int)
   * @note Automatically chooses between inferred and typed versions
   *
   * @code
   * // With type inference support:
-  * DA_BUILDER_APPEND(builder, 42);
+  * DA_PUSH(arr, 42);
   *
   * // Without type inference or with DA_NOT_USE_TYPE_GENERIC:
-  * DA_BUILDER_APPEND(builder, 42, int);
+  * DA_PUSH(arr, 42, int);
   * @endcode
   */
 
  /**
-  * @def DA_BUILDER_PUT(builder, i, val) or DA_BUILDER_PUT(builder, i, val, T)
-  * @brief Type-safe element assignment in builder (adaptive macro)
-  * @param builder Builder to modify
+  * @def DA_PUT(arr, i, val) or DA_PUT(arr, i, val, T)
+  * @brief Type-safe element assignment (adaptive macro)
+  * @param arr Array to modify
   * @param i Index to set
   * @param val Value to assign
   * @param T Type parameter (only when DA_SUPPORT_TYPE_INFERENCE=0 or DA_NOT_USE_TYPE_GENERIC is defined)
-  * @note When DA_SUPPORT_TYPE_INFERENCE=1 and DA_NOT_USE_TYPE_GENERIC is not defined: DA_BUILDER_PUT(builder, 0, 42)
-  * @note When DA_SUPPORT_TYPE_INFERENCE=0 or DA_NOT_USE_TYPE_GENERIC is defined: DA_BUILDER_PUT(builder, 0, 42, int)
+  * @note When DA_SUPPORT_TYPE_INFERENCE=1 and DA_NOT_USE_TYPE_GENERIC is not defined: DA_PUT(arr, 0, 42)
+  * @note When DA_SUPPORT_TYPE_INFERENCE=0 or DA_NOT_USE_TYPE_GENERIC is defined: DA_PUT(arr, 0, 42, int)
   * @note Automatically chooses between inferred and typed versions
   *
   * @code
   * // With type inference support:
-  * DA_BUILDER_PUT(builder, 0, 42);
+  * DA_PUT(arr, 0, 42);
   *
   * // Without type inference or with DA_NOT_USE_TYPE_GENERIC:
-  * DA_BUILDER_PUT(builder, 0, 42, int);
+  * DA_PUT(arr, 0, 42, int);
+  * @endcode
+  */
+
+ /**
+  * @def DA_INSERT(arr, i, val) or DA_INSERT(arr, i, val, T)
+  * @brief Type-safe element insert (adaptive macro)
+  * @param arr Array to modify
+  * @param i Index to insert at
+  * @param val Value to insert
+  * @param T Type parameter (only when DA_SUPPORT_TYPE_INFERENCE=0 or DA_NOT_USE_TYPE_GENERIC is defined)
+  * @note When DA_SUPPORT_TYPE_INFERENCE=1 and DA_NOT_USE_TYPE_GENERIC is not defined: DA_INSERT(arr, 0, 42)
+  * @note When DA_SUPPORT_TYPE_INFERENCE=0 or DA_NOT_USE_TYPE_GENERIC is defined: DA_INSERT(arr, 0, 42, int)
+  * @note Automatically chooses between inferred and typed versions
+  *
+  * @code
+  * // With type inference support:
+  * DA_INSERT(arr, 0, 42);
+  *
+  * // Without type inference or with DA_NOT_USE_TYPE_GENERIC:
+  * DA_INSERT(arr, 0, 42, int);
+  * @endcode
+  */
+
+/**
+ * @def DA_AT(arr, i, T)
+ * @brief Type-safe element access by value
+ * @param arr Array to access
+ * @param i Index to get
+ * @param T Element type
+ * @return Element value at index i
+ *
+ * @code
+ * int value = DA_AT(arr, 0, int);
+ * @endcode
+ */
+
+/**
+ * @def DA_LENGTH(arr)
+ * @brief Get array length (shorthand for da_length)
+ */
+
+/**
+ * @def DA_CAPACITY(arr)
+ * @brief Get array capacity (shorthand for da_capacity)
+ */
+
+/**
+ * @def DA_POP(arr, out_ptr)
+ * @brief Pop last element (shorthand for da_pop)
+ */
+
+/**
+ * @def DA_CLEAR(arr)
+ * @brief Clear array (shorthand for da_clear)
+ */
+
+/**
+ * @def DA_RESERVE(arr, cap)
+ * @brief Reserve capacity (shorthand for da_reserve)
+ */
+
+/**
+ * @def DA_RESIZE(arr, len)
+ * @brief Resize array (shorthand for da_resize)
+ */
+
+/**
+ * @def DA_INSERT(arr, i, val)
+ * @brief Type-safe element insert (with typeof support)
+ * @param arr Array to modify
+ * @param i Index to insert at
+ * @param val Value to insert
+ * @note With typeof support: DA_INSERT(arr, 0, 42)
+ * @note Without typeof: DA_INSERT(arr, 0, 42, int)
+ */
+
+/**
+ * @def DA_REMOVE(arr, i, out_ptr)
+ * @brief Remove element at index (shorthand for da_remove)
+ * @param arr Array to modify
+ * @param i Index to remove from
+ * @param out_ptr Optional pointer to store removed element (can be NULL)
+ */
+
+/** @} */ // end of array_macros group
+
+#define DA_NEW(T) da_new(sizeof(T))
+#define DA_CREATE(T, cap, retain_fn, release_fn) da_create(sizeof(T), cap, retain_fn, release_fn)
+
+#define DA_PUSH_TYPED(arr, val, T) do { T _temp = (val); da_push(arr, (void*)&_temp); } while(0)
+#define DA_PUT_TYPED(arr, i, val, T) do { T _temp = (val); da_set(arr, i, (void*)&_temp); } while(0)
+#define DA_INSERT_TYPED(arr, i, val, T) do { T _temp = (val); da_insert(arr, i, (void*)&_temp); } while(0)
+
+#if DA_SUPPORT_TYPE_INFERENCE
+    #define DA_PUSH_INFERRED(arr, val) do { DA_MAKE_VAR_WITH_INFERRED_TYPE(_temp, val); da_push(arr, (void*)&_temp); } while(0)
+    #define DA_PUT_INFERRED(arr, i, val) do { DA_MAKE_VAR_WITH_INFERRED_TYPE(_temp, val); da_set(arr, i, (void*)&_temp); } while(0)
+    #define DA_INSERT_INFERRED(arr, i, val) do { DA_MAKE_VAR_WITH_INFERRED_TYPE(_temp, val); da_insert(arr, i, (void*)&_temp); } while(0)
+#endif
+
+#if DA_SUPPORT_TYPE_INFERENCE && !defined(DA_NOT_USE_TYPE_GENERIC)
+    #define DA_PUSH(arr, val) DA_PUSH_INFERRED(arr, val)
+    #define DA_PUT(arr, i, val) DA_PUT_INFERRED(arr, i, val)
+    #define DA_INSERT(arr, i, val) DA_INSERT_INFERRED(arr, i, val)
+#else
+    #define DA_PUSH(arr, val, T) DA_PUSH_TYPED(arr, val, T)
+    #define DA_PUT(arr, i, val, T) DA_PUT_TYPED(arr, i, val, T)
+    #define DA_INSERT(arr, i, val, T) DA_INSERT_TYPED(arr, i, val, T)
+#endif
+
+#define DA_LENGTH(arr) da_length(arr)
+#define DA_CAPACITY(arr) da_capacity(arr)
+#define DA_AT(arr, i, T) (*(T*)da_get(arr, i))
+#define DA_POP(arr, out_ptr) da_pop(arr, out_ptr)
+#define DA_REMOVE(arr, i, out_ptr) da_remove(arr, i, out_ptr)
+#define DA_CLEAR(arr) da_clear(arr)
+#define DA_RESERVE(arr, cap) da_reserve(arr, cap)
+#define DA_RESIZE(arr, len) da_resize(arr, len)
+#define DA_TRIM(arr, cap) da_trim(arr, cap)
+#define DA_SHRINK_TO_FIT(arr) da_trim(arr, da_length(arr))
+#define DA_PEEK(arr, T) (*(T*)da_peek(arr))
+#define DA_PEEK_FIRST(arr, T) (*(T*)da_peek_first(arr))
+
+/**
+ * @defgroup builder_macros Type-Safe Builder Macros
+ * @brief Convenient type-safe macros for builder operations
+ * @{
+ */
+
+ /**
+  * @def DA_BUILDER_CREATE(T)
+  * @brief Type-safe builder creation
+  * @param T Element type (e.g., int, float, struct mytype)
+  * @return New da_builder sized for type T
+  *
+  * @code
+  * da_builder builder = DA_BUILDER_CREATE(int);
+  * @endcode
+  */
+
+ /**
+  * @def DA_BUILDER_APPEND_TYPED(builder, val, T)
+  * @brief Type-safe element append to builder with explicit type parameter
+  * @param builder Builder to modify
+  * @param val Value to append
+  * @param T Explicit type of the value
+  * @note Always requires explicit type parameter
+  *
+  * @code
+  * DA_BUILDER_APPEND_TYPED(builder, 42, int);
+  * @endcode
+  */
+
+ /**
+  * @def DA_BUILDER_PUT_TYPED(builder, i, val, T)
+  * @brief Type-safe element assignment in builder with explicit type parameter
+  * @param builder Builder to modify
+  * @param i Index to set
+  * @param val Value to assign
+  * @param T Explicit type of the value
+  * @note Always requires explicit type parameter
+  *
+  * @code
+  * DA_BUILDER_PUT_TYPED(builder, 0, 42, int);
+  * @endcode
+  */
+
+ /**
+  * @def DA_BUILDER_APPEND_INFERRED(builder, val)
+  * @brief Type-safe element append to builder with automatic type inference
+  * @param builder Builder to modify
+  * @param val Value to append
+  * @note Only available when DA_SUPPORT_TYPE_INFERENCE=1
+  * @note Automatically infers type using typeof or auto
+  *
+  * @code
+  * DA_BUILDER_APPEND_INFERRED(builder, 42);  // Type inferred as int
   * @endcode
   */
 
-/**
- * @def DA_BUILDER_AT(builder, i, T)
- * @brief Type-safe element access by value from builder
- * @param builder Builder to access
- * @param i Index to get
- * @param T Element type
- * @return Element value at index i
- *
- * @code
- * int value = DA_BUILDER_AT(builder, 0, int);
- * @endcode
- */
+ /**
+  * @def DA_BUILDER_PUT_INFERRED(builder, i, val)
+  * @brief Type-safe element assignment in builder with automatic type inference
+  * @param builder Builder to modify
+  * @param i Index to set
+  * @param val Value to assign
+  * @note Only available when DA_SUPPORT_TYPE_INFERENCE=1
+  * @note Automatically infers type using typeof or auto
+  *
+  * @code
+  * DA_BUILDER_PUT_INFERRED(builder, 0, 42);  // Type inferred as int
+  * @endcode
+  */
+
+ /**
+  * @def DA_BUILDER_APPEND(builder, val) or DA_BUILDER_APPEND(builder, val, T)
+  * @brief Type-safe element append to builder (adaptive macro)
+  * @param builder Builder to modify
+  * @param val Value to append
+  * @param T Type parameter (only when DA_SUPPORT_TYPE_INFERENCE=0 or DA_NOT_USE_TYPE_GENERIC is defined)
+  * @note When DA_SUPPORT_TYPE_INFERENCE=1 and DA_NOT_USE_TYPE_GENERIC is not defined: DA_BUILDER_APPEND(builder, 42)
+  * @note When DA_SUPPORT_TYPE_INFERENCE=0 or DA_NOT_USE_TYPE_GENERIC is defined: DA_BUILDER_APPEND(builder, 42, int)
+  * @note Automatically chooses between inferred and typed versions
+  *
+  * @code
+  * // With type inference support:
+  * DA_BUILDER_APPEND(builder, 42);
+  *
+  * // Without type inference or with DA_NOT_USE_TYPE_GENERIC:
+  * DA_BUILDER_APPEND(builder, 42, int);
+  * @endcode
+  */
+
+ /**
+  * @def DA_BUILDER_PUT(builder, i, val) or DA_BUILDER_PUT(builder, i, val, T)
+  * @brief Type-safe element assignment in builder (adaptive macro)
+  * @param builder Builder to modify
+  * @param i Index to set
+  * @param val Value to assign
+  * @param T Type parameter (only when DA_SUPPORT_TYPE_INFERENCE=0 or DA_NOT_USE_TYPE_GENERIC is defined)
+  * @note When DA_SUPPORT_TYPE_INFERENCE=1 and DA_NOT_USE_TYPE_GENERIC is not defined: DA_BUILDER_PUT(builder, 0, 42)
+  * @note When DA_SUPPORT_TYPE_INFERENCE=0 or DA_NOT_USE_TYPE_GENERIC is defined: DA_BUILDER_PUT(builder, 0, 42, int)
+  * @note Automatically chooses between inferred and typed versions
+  *
+  * @code
+  * // With type inference support:
+  * DA_BUILDER_PUT(builder, 0, 42);
+  *
+  * // Without type inference or with DA_NOT_USE_TYPE_GENERIC:
+  * DA_BUILDER_PUT(builder, 0, 42, int);
+  * @endcode
+  */
+
+/**
+ * @def DA_BUILDER_AT(builder, i, T)
+ * @brief Type-safe element access by value from builder
+ * @param builder Builder to access
+ * @param i Index to get
+ * @param T Element type
+ * @return Element value at index i
+ *
+ * @code
+ * int value = DA_BUILDER_AT(builder, 0, int);
+ * @endcode
+ */
+
+/**
+ * @def DA_BUILDER_LEN(builder)
+ * @brief Get builder length (shorthand for da_builder_length)
+ */
+
+/**
+ * @def DA_BUILDER_CAP(builder)
+ * @brief Get builder capacity (shorthand for da_builder_capacity)
+ */
+
+/**
+ * @def DA_BUILDER_CLEAR(builder)
+ * @brief Clear builder (shorthand for da_builder_clear)
+ */
+
+/**
+ * @def DA_BUILDER_TO_ARRAY(builder)
+ * @brief Convert builder to array (shorthand for da_builder_to_array)
+ */
+
+#define DA_BUILDER_CREATE(T) da_builder_create(sizeof(T))
+
+#define DA_BUILDER_APPEND_TYPED(builder, val, T) do { T _temp = (val); da_builder_append(builder, (void*)&_temp); } while(0)
+#define DA_BUILDER_PUT_TYPED(builder, i, val, T) do { T _temp = (val); da_builder_set(builder, i, (void*)&_temp); } while(0)
+
+#if DA_SUPPORT_TYPE_INFERENCE
+    #define DA_BUILDER_APPEND_INFERRED(builder, val) \
+        do { DA_MAKE_VAR_WITH_INFERRED_TYPE(_temp, val); da_builder_append(builder, (void*)&_temp); } while(0)
+    #define DA_BUILDER_PUT_INFERRED(builder, i, val) \
+        do { DA_MAKE_VAR_WITH_INFERRED_TYPE(_temp, val); da_builder_set(builder, i, (void*)&_temp); } while(0)
+#endif
+
+#if DA_SUPPORT_TYPE_INFERENCE && !defined(DA_NOT_USE_TYPE_GENERIC)
+    #define DA_BUILDER_APPEND(builder, val) DA_BUILDER_APPEND_INFERRED(builder, val)
+    #define DA_BUILDER_PUT(builder, i, val) DA_BUILDER_PUT_INFERRED(builder, i, val)
+#else
+    #define DA_BUILDER_APPEND(builder, val, T) DA_BUILDER_APPEND_TYPED(builder, val, T)
+    #define DA_BUILDER_PUT(builder, i, val, T) DA_BUILDER_PUT_TYPED(builder, i, val, T)
+#endif
+/** @} */ // end of builder_macros group
+
+
+#define DA_BUILDER_LEN(builder) da_builder_length(builder)
+#define DA_BUILDER_CAP(builder) da_builder_capacity(builder)
+#define DA_BUILDER_AT(builder, i, T) (*(T*)da_builder_get(builder, i))
+#define DA_BUILDER_CLEAR(builder) da_builder_clear(builder)
+#define DA_BUILDER_TO_ARRAY(builder) da_builder_to_array(builder, NULL, NULL)
+#define DA_BUILDER_TO_ARRAY_MANAGED(builder, retain_fn, release_fn) da_builder_to_array(builder, retain_fn, release_fn)
+
+/**
+ * @defgroup typed_arrays Monomorphic Typed Arrays
+ * @brief Generate a typed API for one element type over the regular da_array layout
+ * @{
+ */
+
+/**
+ * @def DA_DEFINE_TYPED(name, T)
+ * @brief Generates static inline functions specialized for element type T
+ * @param name Prefix for the generated type and functions
+ * @param T Element type
+ *
+ * Generates the handle type `name_arr` (a plain da_array, so typed and untyped
+ * handles are interchangeable and work with da_retain()/da_release()) and:
+ *
+ * - name_new(), name_create(cap, retain_fn, release_fn)
+ * - name_length(), name_capacity(), name_data(), name_at(), name_get()
+ * - name_set(), name_push(), name_pop(), name_insert(), name_remove()
+ * - name_peek(), name_peek_first(), name_append(), name_swap(), name_reverse()
+ * - name_find_index(), name_sort()
+ *
+ * Every operation sees sizeof(T) at compile time, so element copies become plain
+ * assignments and index math becomes shifts. Growth goes through da_grow() and
+ * retain_fn/release_fn are honored exactly as in the untyped API.
+ *
+ * @note name_sort() is an in-place quicksort with insertion sort for short ranges (not stable)
+ * @note Use once per element type at file scope
+ *
+ * @code
+ * DA_DEFINE_TYPED(ints, int)
+ *
+ * ints_arr arr = ints_new();
+ * ints_push(arr, 42);
+ * int x = ints_get(arr, 0);
+ * *ints_at(arr, 0) = 7;
+ * da_release(&arr);
+ * @endcode
+ */
+
+/** @} */ // end of typed_arrays group
+
+#define DA_DEFINE_TYPED(name, T) \
+    typedef da_array name##_arr; \
+    \
+    DA_INLINE name##_arr name##_new(void) { \
+        return da_new((da_int_t)sizeof(T)); \
+    } \
+    \
+    DA_INLINE name##_arr name##_create(da_int_t initial_capacity, void (*retain_fn)(void*), void (*release_fn)(void*)) { \
+        return da_create((da_int_t)sizeof(T), initial_capacity, retain_fn, release_fn); \
+    } \
+    \
+    DA_INLINE da_int_t name##_length(name##_arr arr) { \
+        DA_FASTPATH_ASSERT(arr != NULL); \
+        return arr->length; \
+    } \
+    \
+    DA_INLINE da_int_t name##_capacity(name##_arr arr) { \
+        DA_FASTPATH_ASSERT(arr != NULL); \
+        return arr->capacity; \
+    } \
+    \
+    DA_INLINE T* name##_data(name##_arr arr) { \
+        DA_FASTPATH_ASSERT(arr != NULL); \
+        return (T*)arr->data; \
+    } \
+    \
+    DA_INLINE T* name##_at(name##_arr arr, da_int_t index) { \
+        DA_FASTPATH_ASSERT(arr != NULL && arr->element_size == (da_int_t)sizeof(T)); \
+        DA_FASTPATH_ASSERT(index >= 0 && index < arr->length); \
+        return (T*)arr->data + index; \
+    } \
+    \
+    DA_INLINE T name##_get(name##_arr arr, da_int_t index) { \
+        return *name##_at(arr, index); \
+    } \
+    \
+    DA_INLINE void name##_set(name##_arr arr, da_int_t index, T value) { \
+        DA_CHECK_MUTABLE(arr); \
+        DA_COW_UNSHARE(arr); \
+        T* slot = name##_at(arr, index); \
+        if (arr->release_fn) arr->release_fn(slot); \
+        *slot = value; \
+        if (arr->retain_fn) arr->retain_fn(slot); \
+    } \
+    \
+    DA_INLINE void name##_push(name##_arr arr, T value) { \
+        DA_FASTPATH_ASSERT(arr != NULL && arr->element_size == (da_int_t)sizeof(T)); \
+        if (DA_UNLIKELY(arr->length >= arr->capacity)) { \
+            da_grow(arr, arr->length + 1); \
+        } \
+        T* slot = (T*)arr->data + arr->length; \
+        *slot = value; \
+        if (arr->retain_fn) arr->retain_fn(slot); \
+        arr->length++; \
+    } \
+    \
+    DA_INLINE T name##_pop(name##_arr arr) { \
+        DA_FASTPATH_ASSERT(arr != NULL && arr->element_size == (da_int_t)sizeof(T)); \
+        DA_FASTPATH_ASSERT(arr->length > 0); \
+        DA_CHECK_MUTABLE(arr); \
+        DA_COW_UNSHARE(arr); \
+        T* slot = (T*)arr->data + --arr->length; \
+        T value = *slot; \
+        if (arr->release_fn) arr->release_fn(slot); \
+        if (DA_UNLIKELY(arr->growth != NULL)) da_auto_shrink(arr); \
+        return value; \
+    } \
+    \
+    DA_INLINE T name##_peek(name##_arr arr) { \
+        DA_FASTPATH_ASSERT(arr != NULL && arr->length > 0); \
+        return ((T*)arr->data)[arr->length - 1]; \
+    } \
+    \
+    DA_INLINE T name##_peek_first(name##_arr arr) { \
+        DA_FASTPATH_ASSERT(arr != NULL && arr->length > 0); \
+        return ((T*)arr->data)[0]; \
+    } \
+    \
+    DA_INLINE void name##_insert(name##_arr arr, da_int_t index, T value) { \
+        DA_FASTPATH_ASSERT(arr != NULL && arr->element_size == (da_int_t)sizeof(T)); \
+        DA_FASTPATH_ASSERT(index >= 0 && index <= arr->length); \
+        if (DA_UNLIKELY(arr->length >= arr->capacity)) { \
+            da_grow(arr, arr->length + 1); \
+        } \
+        T* data = (T*)arr->data; \
+        memmove(data + index + 1, data + index, (size_t)(arr->length - index) * sizeof(T)); \
+        data[index] = value; \
+        if (arr->retain_fn) arr->retain_fn(&data[index]); \
+        arr->length++; \
+    } \
+    \
+    DA_INLINE T name##_remove(name##_arr arr, da_int_t index) { \
+        DA_CHECK_MUTABLE(arr); \
+        DA_COW_UNSHARE(arr); \
+        T* data = name##_at(arr, index); \
+        T value = *data; \
+        if (arr->release_fn) arr->release_fn(data); \
+        memmove(data, data + 1, (size_t)(arr->length - index - 1) * sizeof(T)); \
+        arr->length--; \
+        if (DA_UNLIKELY(arr->growth != NULL)) da_auto_shrink(arr); \
+        return value; \
+    } \
+    \
+    DA_INLINE void name##_append(name##_arr arr, const T* values, da_int_t count) { \
+        DA_FASTPATH_ASSERT(arr != NULL && arr->element_size == (da_int_t)sizeof(T)); \
+        DA_FASTPATH_ASSERT(count >= 0 && (values != NULL || count == 0)); \
+        DA_FASTPATH_ASSERT(count <= DA_INT_MAX - arr->length); \
+        if (arr->length + count > arr->capacity) { \
+            da_grow(arr, arr->length + count); \
+        } \
+        T* dest = (T*)arr->data + arr->length; \
+        for (da_int_t i = 0; i < count; i++) { \
+            dest[i] = values[i]; \
+            if (arr->retain_fn) arr->retain_fn(&dest[i]); \
+        } \
+        arr->length += count; \
+    } \
+    \
+    DA_INLINE void name##_swap(name##_arr arr, da_int_t i, da_int_t j) { \
+        DA_CHECK_MUTABLE(arr); \
+        DA_COW_UNSHARE(arr); \
+        T* a = name##_at(arr, i); \
+        T* b = name##_at(arr, j); \
+        T tmp = *a; \
+        *a = *b; \
+        *b = tmp; \
+    } \
+    \
+    DA_INLINE void name##_reverse(name##_arr arr) { \
+        DA_FASTPATH_ASSERT(arr != NULL && arr->element_size == (da_int_t)sizeof(T)); \
+        DA_CHECK_MUTABLE(arr); \
+        DA_COW_UNSHARE(arr); \
+        T* data = (T*)arr->data; \
+        for (da_int_t i = 0, j = arr->length - 1; i < j; i++, j--) { \
+            T tmp = data[i]; \
+            data[i] = data[j]; \
+            data[j] = tmp; \
+        } \
+    } \
+    \
+    DA_INLINE da_int_t name##_find_index(name##_arr arr, int (*predicate)(const T* element, void* context), void* context) { \
+        DA_FASTPATH_ASSERT(arr != NULL && predicate != NULL); \
+        const T* data = (const T*)arr->data; \
+        for (da_int_t i = 0; i < arr->length; i++) { \
+            if (predicate(&data[i], context)) return i; \
+        } \
+        return -1; \
+    } \
+    \
+    /* Sorts data[lo, hi): quicksort on the larger side, recursion on the smaller */ \
+    DA_INLINE void name##_sort_range(T* data, da_int_t lo, da_int_t hi, int (*compare)(const T* a, const T* b)) { \
+        while (hi - lo > 16) { \
+            da_int_t mid = lo + (hi - lo) / 2; \
+            T tmp; \
+            /* Median of three ends up in data[mid] */ \
+            if (compare(&data[mid], &data[lo]) < 0) { tmp = data[mid]; data[mid] = data[lo]; data[lo] = tmp; } \
+            if (compare(&data[hi - 1], &data[mid]) < 0) { \
+                tmp = data[mid]; data[mid] = data[hi - 1]; data[hi - 1] = tmp; \
+                if (compare(&data[mid], &data[lo]) < 0) { tmp = data[mid]; data[mid] = data[lo]; data[lo] = tmp; } \
+            } \
+            T pivot = data[mid]; \
+            da_int_t i = lo, j = hi - 1; \
+            while (i <= j) { \
+                while (compare(&data[i], &pivot) < 0) i++; \
+                while (compare(&pivot, &data[j]) < 0) j--; \
+                if (i <= j) { tmp = data[i]; data[i] = data[j]; data[j] = tmp; i++; j--; } \
+            } \
+            if (j + 1 - lo < hi - i) { \
+                name##_sort_range(data, lo, j + 1, compare); \
+                lo = i; \
+            } else { \
+                name##_sort_range(data, i, hi, compare); \
+                hi = j + 1; \
+            } \
+        } \
+        /* Insertion sort for short ranges */ \
+        for (da_int_t i = lo + 1; i < hi; i++) { \
+            T value = data[i]; \
+            da_int_t j = i - 1; \
+            while (j >= lo && compare(&value, &data[j]) < 0) { \
+                data[j + 1] = data[j]; \
+                j--; \
+            } \
+            data[j + 1] = value; \
+        } \
+    } \
+    \
+    DA_INLINE void name##_sort(name##_arr arr, int (*compare)(const T* a, const T* b)) { \
+        DA_FASTPATH_ASSERT(arr != NULL && compare != NULL); \
+        DA_FASTPATH_ASSERT(arr->element_size == (da_int_t)sizeof(T)); \
+        DA_CHECK_MUTABLE(arr); \
+        DA_COW_UNSHARE(arr); \
+        name##_sort_range((T*)arr->data, 0, arr->length, compare); \
+    }
+
+/**
+ * @defgroup arena Arena Allocator
+ * @brief Bump-pointer arena for transient arrays and builders, freed in bulk
+ * @{
+ */
+
+/**
+ * @brief One chunk of arena memory; allocations are carved from the bytes after the header
+ */
+typedef struct da_arena_chunk {
+    struct da_arena_chunk* next; /**< @brief Next chunk in the arena */
+    size_t size;                 /**< @brief Usable bytes in this chunk */
+    size_t used;                 /**< @brief Bytes handed out from this chunk */
+} da_arena_chunk;
+
+/**
+ * @brief Bump-pointer arena usable as a da_allocator
+ * @note Freeing is a no-op (except for the most recent allocation, which is rolled back)
+ * @note Resizing the most recent allocation extends it in place when the chunk has room,
+ *       so an array that is the last thing allocated in the arena grows without copying
+ */
+typedef struct {
+    da_allocator allocator;   /**< @brief Allocator interface whose context is this arena */
+    da_arena_chunk* head;     /**< @brief First chunk (chunks are kept across resets) */
+    da_arena_chunk* current;  /**< @brief Chunk currently being bumped */
+    size_t chunk_bytes;       /**< @brief Usable size of regular chunks */
+    void* last;               /**< @brief Most recent allocation (NULL if none or rolled back) */
+    size_t last_size;         /**< @brief Aligned size of the most recent allocation */
+} da_arena_t, *da_arena;
+
+/**
+ * @brief Creates an empty arena
+ * @param chunk_bytes Usable size of each chunk (0 = DA_ARENA_CHUNK_BYTES)
+ * @return New arena; chunks are obtained with DA_MALLOC on demand
+ * @note Allocations larger than chunk_bytes get a dedicated chunk
+ * @note Asserts on allocation failure
+ *
+ * @code
+ * da_arena frame = da_arena_create(0);
+ * da_array queue = DA_ARENA_NEW(frame, RenderCmd);
+ * // ... build and use arrays for one frame ...
+ * da_arena_reset(frame);  // drops every array in the arena at once
+ * @endcode
+ */
+DA_DEF da_arena da_arena_create(size_t chunk_bytes);
+
+/**
+ * @brief Returns the allocator interface of an arena
+ * @param arena Arena (must not be NULL)
+ * @return Allocator to pass to da_create_with_allocator() or da_builder_create_with_allocator()
+ */
+DA_DEF const da_allocator* da_arena_allocator(da_arena arena);
+
+/**
+ * @brief Drops every allocation in the arena at once
+ * @param arena Arena (must not be NULL)
+ * @note Chunks are kept and reused, so a steady per-frame workload stops calling DA_MALLOC
+ * @warning Every array and builder allocated from the arena becomes invalid;
+ *          do not use or release them afterwards, and release_fn is not called for their elements
+ */
+DA_DEF void da_arena_reset(da_arena arena);
+
+/**
+ * @brief Frees all arena memory and the arena itself
+ * @param arena Pointer to arena (must not be NULL, *arena must not be NULL)
+ * @note Sets *arena to NULL
+ * @warning Same invalidation rules as da_arena_reset()
+ */
+DA_DEF void da_arena_destroy(da_arena* arena);
+
+/**
+ * @brief Returns the number of bytes currently handed out by the arena
+ * @param arena Arena (must not be NULL)
+ * @return Sum of used bytes over all chunks (including alignment padding)
+ */
+DA_DEF size_t da_arena_used(da_arena arena);
+
+/**
+ * @brief Creates an empty array of type T in an arena
+ * @param arena Arena to allocate from
+ * @param T Element type
+ */
+#define DA_ARENA_NEW(arena, T) da_create_with_allocator(sizeof(T), 0, NULL, NULL, da_arena_allocator(arena))
+
+/**
+ * @brief Creates a builder for type T in an arena
+ * @param arena Arena to allocate from
+ * @param T Element type
+ */
+#define DA_ARENA_BUILDER_CREATE(arena, T) da_builder_create_with_allocator(sizeof(T), da_arena_allocator(arena))
+
+/** @} */ // end of arena group
+
+/**
+ * @defgroup header_pool Header Pool
+ * @brief Per-thread recycling of array and builder headers (DA_HEADER_POOL_SIZE > 0)
+ * @{
+ */
+
+/**
+ * @brief Header pool counters for the calling thread
+ */
+typedef struct {
+    long long hits;       /**< @brief Headers served from the pool */
+    long long misses;     /**< @brief Poolable headers that had to come from DA_MALLOC */
+    long long recycled;   /**< @brief Freed headers kept in the pool */
+    long long overflows;  /**< @brief Freed headers passed to DA_FREE because the pool was full */
+    int cached_arrays;    /**< @brief da_array_t headers currently cached */
+    int cached_builders;  /**< @brief da_builder_t headers currently cached */
+} da_header_pool_stats;
+
+/**
+ * @brief Returns the header pool counters of the calling thread
+ * @return Counters (all zero when DA_HEADER_POOL_SIZE is 0)
+ * @note Hit rate = hits / (hits + misses)
+ */
+DA_DEF da_header_pool_stats da_header_pool_get_stats(void);
+
+/**
+ * @brief Frees the headers cached by the calling thread and resets its counters
+ * @note Call before a thread exits to return its cached headers to DA_FREE
+ */
+DA_DEF void da_header_pool_trim(void);
+
+/** @} */ // end of header_pool group
+
+/**
+ * @defgroup buffer_cache Buffer Cache
+ * @brief Per-thread size-class cache of freed element buffers (DA_BUFFER_CACHE_BYTES > 0)
+ * @{
+ */
+
+/**
+ * @brief Buffer cache counters for the calling thread
+ */
+typedef struct {
+    long long hits;       /**< @brief Buffers served from the cache */
+    long long misses;     /**< @brief Cacheable buffers that had to come from DA_MALLOC/DA_REALLOC */
+    long long recycled;   /**< @brief Freed buffers kept in the cache */
+    long long overflows;  /**< @brief Freed buffers passed to DA_FREE because of the high-water limit */
+    size_t cached_bytes;  /**< @brief Bytes currently held by the cache */
+} da_buffer_cache_stats;
+
+/**
+ * @brief Returns the buffer cache counters of the calling thread
+ * @return Counters (all zero when DA_BUFFER_CACHE_BYTES is 0)
+ */
+DA_DEF da_buffer_cache_stats da_buffer_cache_get_stats(void);
+
+/**
+ * @brief Frees cached buffers of the calling thread until at most max_bytes remain
+ * @param max_bytes Bytes to keep (0 = free every cached buffer and reset the counters)
+ * @return Number of bytes released to DA_FREE
+ * @note Largest size classes are released first
+ */
+DA_DEF size_t da_buffer_cache_trim(size_t max_bytes);
+
+/** @} */ // end of buffer_cache group
+
+/**
+ * @defgroup hugepage Huge Pages
+ * @brief Transparent huge page hinting for mmap element storage (Linux)
+ * @{
+ */
+
+/**
+ * @brief Sets the byte size from which new mmap storage is 2 MB aligned and advised MADV_HUGEPAGE
+ * @param bytes New threshold (0 = no hinting); starts out as DA_HUGEPAGE_THRESHOLD
+ * @return Previous threshold
+ * @note Process-wide and not synchronized: set it before creating large arrays
+ * @note Only affects storage that is mmap'ed, i.e. at least DA_MMAP_THRESHOLD bytes;
+ *       a no-op when mmap storage is unavailable
+ *
+ * @code
+ * da_hugepage_set_threshold(64 << 20);       // hint buffers of 64 MB and more
+ * da_array table = da_new(sizeof(uint64_t));
+ * da_reserve(table, 1 << 28);                // 2 GB, backed by huge pages where available
+ * @endcode
+ */
+DA_DEF size_t da_hugepage_set_threshold(size_t bytes);
+
+/** @} */ // end of hugepage group
+
+/**
+ * @defgroup registry Registry
+ * @brief Process-wide list of live arrays and builders for memory-pressure trimming (DA_REGISTRY=1)
+ * @{
+ */
+
+/**
+ * @brief What da_trim_all() trims
+ */
+typedef struct {
+    int slack_percent;      /**< @brief Capacity kept beyond the length, in percent of the length (0 = trim to length) */
+    size_t min_slack_bytes; /**< @brief Leave arrays alone whose trimmable slack is smaller than this */
+    int include_builders;   /**< @brief Also trim builders (their next appends will grow again) */
+} da_trim_policy;
+
+/**
+ * @brief Registry totals
+ */
+typedef struct {
+    long long arrays;       /**< @brief Live registered arrays */
+    long long builders;     /**< @brief Live registered builders */
+    size_t capacity_bytes;  /**< @brief Heap element bytes held by them */
+    size_t length_bytes;    /**< @brief Of which in use */
+} da_registry_stats;
+
+/**
+ * @brief Shrinks the capacity of every registered array (and optionally builder) towards its length
+ * @param policy What to trim (NULL = every array to its exact length, no builders)
+ * @return Element bytes handed back to the allocators (0 when DA_REGISTRY is 0)
+ * @note Meant for memory-pressure handlers: no other thread may be using registered arrays while it runs
+ * @note Storage inside the header block (DA_SBO_BYTES, DA_SINGLE_ALLOC) is left alone
+ *
+ * @code
+ * da_trim_policy keep_quarter = { 25, 4096, 1 };
+ * size_t freed = da_trim_all(&keep_quarter);  // keep 25% headroom, skip tiny arrays, trim builders too
+ * @endcode
+ */
+DA_DEF size_t da_trim_all(const da_trim_policy* policy);
+
+/**
+ * @brief Returns totals over all registered arrays and builders
+ * @return Counters (all zero when DA_REGISTRY is 0)
+ */
+DA_DEF da_registry_stats da_registry_get_stats(void);
+
+/**
+ * @brief Calls fn for every registered array, e.g. to find the ones holding slack
+ * @param fn Callback (must not create or release arrays or builders)
+ * @param context User context passed to fn
+ * @note Holds the registry lock for the whole walk
+ */
+DA_DEF void da_registry_for_each(void (*fn)(da_array arr, void* context), void* context);
+
+/** @} */ // end of registry group
+
+/* Fast Path
+ *
+ * Emitted in every translation unit as static inline when DA_INLINE_FASTPATH=1,
+ * otherwise as regular definitions in the DA_IMPLEMENTATION translation unit.
+ */
+#if DA_INLINE_FASTPATH || defined(DA_IMPLEMENTATION)
+
+DA_FASTPATH_DEF void* da_get(da_array arr, da_int_t index) {
+    DA_FASTPATH_ASSERT(arr != NULL);
+    DA_FASTPATH_ASSERT(index >= 0 && index < arr->length);
+    return (char*)arr->data + (index * arr->element_size);
+}
+
+DA_FASTPATH_DEF void* da_data(da_array arr) {
+    DA_FASTPATH_ASSERT(arr != NULL);
+    return arr->data;
+}
+
+DA_FASTPATH_DEF da_int_t da_length(da_array arr) {
+    DA_FASTPATH_ASSERT(arr != NULL);
+    return arr->length;
+}
+
+DA_FASTPATH_DEF da_int_t da_capacity(da_array arr) {
+    DA_FASTPATH_ASSERT(arr != NULL);
+    return arr->capacity;
+}
+
+DA_FASTPATH_DEF const void* da_view_get(da_view_t view, da_int_t index) {
+    DA_FASTPATH_ASSERT(index >= 0 && index < view.length);
+    DA_FASTPATH_ASSERT(view.offset + view.length <= view.parent->length);  /* parent shrank under the view */
+    return (const char*)view.parent->data + ((view.offset + index) * view.parent->element_size);
+}
+
+DA_FASTPATH_DEF const void* da_view_data(da_view_t view) {
+    if (view.length == 0) return NULL;
+    DA_FASTPATH_ASSERT(view.offset + view.length <= view.parent->length);
+    return (const char*)view.parent->data + (view.offset * view.parent->element_size);
+}
+
+DA_FASTPATH_DEF da_int_t da_view_length(da_view_t view) {
+    return view.length;
+}
+
+DA_FASTPATH_DEF void da_push(da_array arr, const void* element) {
+    DA_FASTPATH_ASSERT(arr != NULL);
+    DA_FASTPATH_ASSERT(element != NULL);
+
+    if (DA_UNLIKELY(arr->length >= arr->capacity)) {
+        da_grow(arr, arr->length + 1);
+    }
+
+    void* dest = (char*)arr->data + (arr->length * arr->element_size);
+    memcpy(dest, element, arr->element_size);
+
+    /* Call retain function on the newly added element */
+    if (arr->retain_fn) {
+        arr->retain_fn(dest);
+    }
+
+    arr->length++;
+}
+
+#endif /* DA_INLINE_FASTPATH || DA_IMPLEMENTATION */
+
+/* Implementation */
+#ifdef DA_IMPLEMENTATION
+
+#if DA_USE_USABLE_SIZE && !defined(DA_MALLOC_USABLE_SIZE) && defined(DA_MALLOC_IS_LIBC)
+    #if defined(__GLIBC__)
+        #include <malloc.h>
+        #define DA_MALLOC_USABLE_SIZE(ptr) malloc_usable_size(ptr)
+    #elif defined(__APPLE__)
+        #include <malloc/malloc.h>
+        #define DA_MALLOC_USABLE_SIZE(ptr) malloc_size(ptr)
+    #elif defined(_WIN32)
+        #include <malloc.h>
+        #define DA_MALLOC_USABLE_SIZE(ptr) _msize(ptr)
+    #endif
+#endif
+
+#if DA_HAS_MMAP
+#include <sys/mman.h>
+#include <unistd.h>
+/* Strict ISO modes hide these Linux extensions; the kernel ABI values and the libc symbol are always there */
+#ifndef MAP_ANONYMOUS
+    #if defined(__mips__)
+        #define MAP_ANONYMOUS 0x800
+    #elif defined(__alpha__) || defined(__hppa__)
+        #define MAP_ANONYMOUS 0x10
+    #else
+        #define MAP_ANONYMOUS 0x20
+    #endif
+#endif
+#ifndef MREMAP_MAYMOVE
+#define MREMAP_MAYMOVE 1
+extern void* mremap(void* old_address, size_t old_size, size_t new_size, int flags, ...);
+#endif
+#ifndef MREMAP_FIXED
+#define MREMAP_FIXED 2
+#endif
+#ifndef MADV_HUGEPAGE
+#define MADV_HUGEPAGE 14
+extern int madvise(void* addr, size_t length, int advice);
+#endif
+#endif
+
+/* Number of significant bits in x (0 for 0) */
+static int da_bit_width(unsigned long long x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return x ? (int)(sizeof(x) * CHAR_BIT) - __builtin_clzll(x) : 0;
+#else
+    int bits = 0;
+    while (x) {
+        x >>= 1;
+        bits++;
+    }
+    return bits;
+#endif
+}
+
+/* Smallest current * 2^k that holds min_needed */
+static da_int_t da_grow_double(da_int_t current_capacity, da_int_t min_needed) {
+    da_int_t base = current_capacity > 0 ? current_capacity : 1;
+    if (base >= min_needed) return base;
+
+    int shift = da_bit_width((unsigned long long)((min_needed - 1) / base));  /* 2^shift >= ceil(min/base) */
+    if (base > (DA_INT_MAX >> shift)) return min_needed;  /* would overflow */
+    return base << shift;
+}
+
+/* Smallest current + k * step that holds min_needed */
+static da_int_t da_grow_fixed(da_int_t current_capacity, da_int_t min_needed, da_int_t step) {
+    DA_ASSERT(step > 0);
+    if (current_capacity >= min_needed) return current_capacity;
+
+    da_int_t steps = (min_needed - current_capacity + step - 1) / step;
+    if (steps > (DA_INT_MAX - current_capacity) / step) return min_needed;  /* would overflow */
+    return current_capacity + steps * step;
+}
+
+static da_int_t da_grow_one_and_half(da_int_t current_capacity, da_int_t min_needed) {
+    if (current_capacity > (DA_INT_MAX - current_capacity / 2)) return min_needed;  /* would overflow */
+    da_int_t grown = current_capacity + current_capacity / 2;
+    return grown > min_needed ? grown : min_needed;
+}
+
+/* 1.5x, then the byte size rounded up to a jemalloc-style class: 16, 32, 48, 64, then 4 per power of two */
+static da_int_t da_grow_size_class(da_int_t current_capacity, da_int_t min_needed, da_int_t element_size) {
+    da_int_t target = da_grow_one_and_half(current_capacity, min_needed);
+    if (target > DA_INT_MAX / element_size) return target;  /* too large to round; da_bytes() decides */
+
+    unsigned long long bytes = (unsigned long long)target * (unsigned long long)element_size;
+    unsigned long long rounded;
+    if (bytes <= 64) {
+        rounded = (bytes + 15) & ~15ULL;
+    } else {
+        unsigned long long spacing = 1ULL << (da_bit_width(bytes - 1) - 3);  /* a quarter of the power of two */
+        rounded = (bytes + spacing - 1) & ~(spacing - 1);
+    }
+    if (rounded / (unsigned long long)element_size > (unsigned long long)DA_INT_MAX) return target;
+    return (da_int_t)(rounded / (unsigned long long)element_size);
+}
+
+/* New capacity for at least min_needed elements under a policy (default_kind when policy is NULL) */
+static da_int_t da_policy_capacity(const da_growth_policy* policy, da_growth_kind default_kind, da_int_t default_step,
+                                   da_int_t current_capacity, da_int_t min_needed, da_int_t element_size) {
+    da_growth_kind kind = policy ? policy->kind : default_kind;
+    da_int_t capacity;
+
+    switch (kind) {
+        case DA_GROW_1_5X:
+            capacity = da_grow_one_and_half(current_capacity, min_needed);
+            break;
+        case DA_GROW_FIXED:
+            capacity = da_grow_fixed(current_capacity, min_needed, policy ? policy->step : default_step);
+            break;
+        case DA_GROW_SIZE_CLASS:
+            capacity = da_grow_size_class(current_capacity, min_needed, element_size);
+            break;
+        case DA_GROW_CALLBACK:
+            DA_ASSERT(policy->callback != NULL);
+            capacity = policy->callback(policy->context, current_capacity, min_needed, element_size);
+            DA_ASSERT(capacity >= min_needed);
+            break;
+        case DA_GROW_DOUBLE:
+        default:
+            capacity = da_grow_double(current_capacity, min_needed);
+            break;
+    }
+    return capacity;
+}
+
+static da_int_t da_grow_capacity(da_array arr, da_int_t min_needed) {
+#ifdef DA_GROWTH
+    return da_policy_capacity(arr->growth, DA_GROW_FIXED, DA_GROWTH, arr->capacity, min_needed, arr->element_size);
+#else
+    return da_policy_capacity(arr->growth, DA_GROW_DOUBLE, 0, arr->capacity, min_needed, arr->element_size);
+#endif
+}
+
+static da_int_t da_builder_grow_capacity(da_builder builder, da_int_t min_needed) {
+    /* Builders default to doubling for fast construction */
+    return da_policy_capacity(builder->growth, DA_GROW_DOUBLE, 0, builder->capacity, min_needed, builder->element_size);
+}
+
+
+/* Alignment every allocator already guarantees, and the largest one an array may request */
+#define DA_DEFAULT_ALIGNMENT (2 * sizeof(void*))
+#define DA_MAX_ALIGNMENT 4096
+
+/* Checked size math: allocation byte sizes must fit da_int_t, so element offsets
+ * (index * element_size) computed anywhere else can never overflow */
+static size_t da_bytes(da_int_t count, da_int_t element_size) {
+    DA_ASSERT(count >= 0 && element_size > 0);
+    DA_ASSERT(count <= DA_INT_MAX / element_size);
+    return (size_t)count * (size_t)element_size;
+}
+
+static da_int_t da_add_length(da_int_t a, da_int_t b) {
+    DA_ASSERT(b >= 0 && a <= DA_INT_MAX - b);
+    return a + b;
+}
+
+/* Storage Management
+ *
+ * Every array allocation, reallocation and free goes through these helpers so
+ * that the storage layout (separate buffer or co-allocated with the header)
+ * stays invisible to the rest of the implementation.
+ */
+
+/* Raw memory: route through the per-array allocator, or DA_MALLOC/DA_REALLOC/DA_FREE when it is NULL */
+static void* da_mem_alloc(const da_allocator* a, size_t size) {
+    return a ? a->alloc_fn(a->context, size) : DA_MALLOC(size);
+}
+
+static void da_mem_free(const da_allocator* a, void* ptr, size_t size) {
+    if (a) {
+        a->free_fn(a->context, ptr, size);
+    } else {
+        (void)size;
+        DA_FREE(ptr);
+    }
+}
+
+static void* da_mem_realloc(const da_allocator* a, void* ptr, size_t old_size, size_t new_size) {
+    if (!a) return DA_REALLOC(ptr, new_size);
+    if (a->realloc_fn) return a->realloc_fn(a->context, ptr, old_size, new_size);
+
+    /* No realloc hook: allocate, copy, free */
+    void* fresh = a->alloc_fn(a->context, new_size);
+    if (fresh && ptr) {
+        memcpy(fresh, ptr, old_size < new_size ? old_size : new_size);
+        a->free_fn(a->context, ptr, old_size);
+    }
+    return fresh;
+}
+
+#if DA_HAS_INLINE_STORAGE
+/* Offset of the in-block element storage: the small buffer, or the header size rounded up for alignment */
+#if DA_SBO_BYTES > 0
+#define DA_INLINE_OFFSET offsetof(da_array_t, sbo)
+#else
+#define DA_INLINE_OFFSET ((sizeof(da_array_t) + 2 * sizeof(void*) - 1) & ~(2 * sizeof(void*) - 1))
+#endif
+
+static void* da_inline_data(da_array arr) {
+    return arr->inline_capacity > 0 ? (char*)arr + DA_INLINE_OFFSET : NULL;
+}
+
+static int da_data_is_inline(da_array arr) {
+    return arr->data != NULL && arr->data == da_inline_data(arr);
+}
+
+/* Elements that may live in the header block (none for over-aligned arrays) */
+static da_int_t da_inline_limit(da_array arr) {
+    return arr->alignment > (int)DA_DEFAULT_ALIGNMENT ? 0 : arr->inline_capacity;
+}
+#else
+#define da_data_is_inline(arr) 0
+#endif
+
+#if DA_HEADER_POOL_SIZE > 0 || DA_BUFFER_CACHE_BYTES > 0
+/* Intrusive freelist link stored in a cached block */
+typedef struct da_pool_node {
+    struct da_pool_node* next;
+} da_pool_node;
+#endif
+
+/* Header pool: per-thread freelists of bare da_array_t / da_builder_t headers */
+#if DA_HEADER_POOL_SIZE > 0
+static DA_THREAD_LOCAL da_pool_node* da_pool_arrays;
+static DA_THREAD_LOCAL da_pool_node* da_pool_builders;
+static DA_THREAD_LOCAL da_header_pool_stats da_pool_stats;
+
+static void* da_pool_take(da_pool_node** list, int* cached, size_t bytes) {
+    da_pool_node* node = *list;
+    if (node) {
+        *list = node->next;
+        (*cached)--;
+        da_pool_stats.hits++;
+        return node;
+    }
+    da_pool_stats.misses++;
+    return DA_MALLOC(bytes);
+}
+
+static void da_pool_give(da_pool_node** list, int* cached, void* block) {
+    if (*cached < DA_HEADER_POOL_SIZE) {
+        da_pool_node* node = (da_pool_node*)block;
+        node->next = *list;
+        *list = node;
+        (*cached)++;
+        da_pool_stats.recycled++;
+        return;
+    }
+    da_pool_stats.overflows++;
+    DA_FREE(block);
+}
+#endif
+
+/* Allocates a header block, from the pool when it is a bare header on the default allocator */
+static void* da_header_alloc(const da_allocator* allocator, size_t bytes) {
+#if DA_HEADER_POOL_SIZE > 0
+    if (!allocator && bytes == sizeof(da_array_t)) {
+        return da_pool_take(&da_pool_arrays, &da_pool_stats.cached_arrays, bytes);
+    }
+#endif
+    return da_mem_alloc(allocator, bytes);
+}
+
+static void da_header_dealloc(const da_allocator* allocator, void* block, size_t bytes) {
+#if DA_HEADER_POOL_SIZE > 0
+    if (!allocator && bytes == sizeof(da_array_t)) {
+        da_pool_give(&da_pool_arrays, &da_pool_stats.cached_arrays, block);
+        return;
+    }
+#endif
+    da_mem_free(allocator, block, bytes);
+}
+
+static da_builder da_builder_header_alloc(const da_allocator* allocator) {
+#if DA_HEADER_POOL_SIZE > 0
+    if (!allocator) {
+        return (da_builder)da_pool_take(&da_pool_builders, &da_pool_stats.cached_builders, sizeof(da_builder_t));
+    }
+#endif
+    return (da_builder)da_mem_alloc(allocator, sizeof(da_builder_t));
+}
+
+static void da_builder_header_dealloc(da_builder builder) {
+#if DA_HEADER_POOL_SIZE > 0
+    if (!builder->allocator) {
+        da_pool_give(&da_pool_builders, &da_pool_stats.cached_builders, builder);
+        return;
+    }
+#endif
+    da_mem_free(builder->allocator, builder, sizeof(da_builder_t));
+}
+
+DA_DEF da_header_pool_stats da_header_pool_get_stats(void) {
+#if DA_HEADER_POOL_SIZE > 0
+    return da_pool_stats;
+#else
+    da_header_pool_stats empty = {0, 0, 0, 0, 0, 0};
+    return empty;
+#endif
+}
+
+DA_DEF void da_header_pool_trim(void) {
+#if DA_HEADER_POOL_SIZE > 0
+    da_pool_node* lists[2] = { da_pool_arrays, da_pool_builders };
+    for (int i = 0; i < 2; i++) {
+        da_pool_node* node = lists[i];
+        while (node) {
+            da_pool_node* next = node->next;
+            DA_FREE(node);
+            node = next;
+        }
+    }
+    da_pool_arrays = NULL;
+    da_pool_builders = NULL;
+    memset(&da_pool_stats, 0, sizeof(da_pool_stats));
+#endif
+}
+
+/* Buffer cache: per-thread freelists of element buffers in power-of-two size classes */
+#if DA_BUFFER_CACHE_BYTES > 0
+#define DA_BUFCACHE_MIN_SHIFT 4   /* smallest class: 16 bytes */
+#define DA_BUFCACHE_CLASSES 21    /* largest class: 16 MiB */
+
+static DA_THREAD_LOCAL da_pool_node* da_bufcache_lists[DA_BUFCACHE_CLASSES];
+static DA_THREAD_LOCAL da_buffer_cache_stats da_bufcache_stats;
+
+/* Size class of a buffer, or -1 if too large to cache */
+static int da_bufcache_class(size_t bytes) {
+    int cls = 0;
+    while (((size_t)1 << (cls + DA_BUFCACHE_MIN_SHIFT)) < bytes) {
+        if (++cls == DA_BUFCACHE_CLASSES) return -1;
+    }
+    return cls;
+}
+
+static size_t da_bufcache_class_bytes(int cls) {
+    return (size_t)1 << (cls + DA_BUFCACHE_MIN_SHIFT);
+}
+
+static void* da_bufcache_take(int cls) {
+    da_pool_node* node = da_bufcache_lists[cls];
+    if (node) {
+        da_bufcache_lists[cls] = node->next;
+        da_bufcache_stats.cached_bytes -= da_bufcache_class_bytes(cls);
+        da_bufcache_stats.hits++;
+    } else {
+        da_bufcache_stats.misses++;
+    }
+    return node;
+}
+#endif
+
+/* Large element storage: anonymous mappings rounded to whole pages */
+#if DA_HAS_MMAP
+static size_t da_page_round(size_t bytes) {
+    static size_t page_size = 0;
+    if (page_size == 0) page_size = (size_t)sysconf(_SC_PAGESIZE);
+    return (bytes + page_size - 1) & ~(page_size - 1);
+}
+
+/* Transparent huge pages: mappings at or above the threshold start on a 2 MB boundary and are advised */
+#define DA_HUGEPAGE_BYTES ((size_t)2 << 20)
+
+static size_t da_hugepage_threshold = DA_HUGEPAGE_THRESHOLD;
+
+static int da_hugepage_wanted(size_t bytes) {
+    return da_hugepage_threshold > 0 && bytes >= da_hugepage_threshold;
+}
+
+/* Maps an anonymous region that starts on a huge page boundary by over-mapping and trimming */
+static void* da_mmap_huge_aligned(size_t mapped) {
+    size_t span = mapped + DA_HUGEPAGE_BYTES;
+    char* raw = (char*)mmap(NULL, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == (char*)MAP_FAILED) return NULL;
+
+    char* aligned = (char*)(((uintptr_t)raw + DA_HUGEPAGE_BYTES - 1) & ~(uintptr_t)(DA_HUGEPAGE_BYTES - 1));
+    size_t head = (size_t)(aligned - raw);
+    if (head > 0) munmap(raw, head);
+    if (span - head > mapped) munmap(aligned + mapped, span - head - mapped);
+    madvise(aligned, mapped, MADV_HUGEPAGE);  /* advisory: THP may be disabled */
+    return aligned;
+}
+
+static void* da_mmap_alloc(size_t bytes) {
+    if (da_hugepage_wanted(bytes)) return da_mmap_huge_aligned(da_page_round(bytes));
+    void* ptr = mmap(NULL, da_page_round(bytes), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return ptr == MAP_FAILED ? NULL : ptr;
+}
+
+static void da_mmap_free(void* ptr, size_t bytes) {
+    munmap(ptr, da_page_round(bytes));
+}
+
+/* Both sizes at or above DA_MMAP_THRESHOLD */
+static void* da_mmap_resize(void* ptr, size_t old_size, size_t new_size) {
+    size_t old_mapped = da_page_round(old_size);
+    size_t new_mapped = da_page_round(new_size);
+
+    if (new_mapped == old_mapped) return ptr;
+    if (new_mapped < old_mapped) {
+        /* Shrinking: hand the tail pages back to the OS */
+        munmap((char*)ptr + new_mapped, old_mapped - new_mapped);
+        return ptr;
+    }
+    if (da_hugepage_wanted(new_size)) {
+        /* Grow in place if the address space allows, otherwise move the pages onto an aligned region */
+        void* moved = mremap(ptr, old_mapped, new_mapped, 0);
+        if (moved == MAP_FAILED) {
+            void* target = da_mmap_huge_aligned(new_mapped);
+            if (!target) return NULL;
+            moved = mremap(ptr, old_mapped, new_mapped, MREMAP_MAYMOVE | MREMAP_FIXED, target);
+            if (moved == MAP_FAILED) {
+                munmap(target, new_mapped);
+                return NULL;
+            }
+        }
+        madvise(moved, new_mapped, MADV_HUGEPAGE);
+        return moved;
+    }
+    void* moved = mremap(ptr, old_mapped, new_mapped, MREMAP_MAYMOVE);
+    return moved == MAP_FAILED ? NULL : moved;
+}
+#endif
+
+DA_DEF size_t da_hugepage_set_threshold(size_t bytes) {
+#if DA_HAS_MMAP
+    size_t previous = da_hugepage_threshold;
+    da_hugepage_threshold = bytes;
+    return previous;
+#else
+    (void)bytes;
+    return 0;
+#endif
+}
+
+/* Registry: doubly linked lists of live arrays and builders behind a spinlock */
+#if DA_REGISTRY
+#include <stdatomic.h>
+
+static atomic_flag da_registry_lock = ATOMIC_FLAG_INIT;
+static da_array da_registry_arrays = NULL;
+static da_builder da_registry_builders = NULL;
+
+static void da_registry_acquire(void) {
+    while (atomic_flag_test_and_set_explicit(&da_registry_lock, memory_order_acquire)) {
+        /* spin: critical sections are a few pointer writes */
+    }
+}
+
+static void da_registry_release(void) {
+    atomic_flag_clear_explicit(&da_registry_lock, memory_order_release);
+}
+
+static void* da_arena_alloc_fn(void* context, size_t size);
+
+static void da_registry_add_array(da_array arr) {
+    if (arr->allocator && arr->allocator->alloc_fn == da_arena_alloc_fn) {
+        arr->registry_prev = arr->registry_next = arr;  /* marks "not registered" */
+        return;
+    }
+    da_registry_acquire();
+    arr->registry_prev = NULL;
+    arr->registry_next = da_registry_arrays;
+    if (da_registry_arrays) da_registry_arrays->registry_prev = arr;
+    da_registry_arrays = arr;
+    da_registry_release();
+}
+
+static void da_registry_remove_array(da_array arr) {
+    if (arr->registry_next == arr) return;
+    da_registry_acquire();
+    if (arr->registry_prev) arr->registry_prev->registry_next = arr->registry_next;
+    else da_registry_arrays = arr->registry_next;
+    if (arr->registry_next) arr->registry_next->registry_prev = arr->registry_prev;
+    da_registry_release();
+}
+
+static void da_registry_add_builder(da_builder builder) {
+    if (builder->allocator && builder->allocator->alloc_fn == da_arena_alloc_fn) {
+        builder->registry_prev = builder->registry_next = builder;
+        return;
+    }
+    da_registry_acquire();
+    builder->registry_prev = NULL;
+    builder->registry_next = da_registry_builders;
+    if (da_registry_builders) da_registry_builders->registry_prev = builder;
+    da_registry_builders = builder;
+    da_registry_release();
+}
+
+static void da_registry_remove_builder(da_builder builder) {
+    if (builder->registry_next == builder) return;
+    da_registry_acquire();
+    if (builder->registry_prev) builder->registry_prev->registry_next = builder->registry_next;
+    else da_registry_builders = builder->registry_next;
+    if (builder->registry_next) builder->registry_next->registry_prev = builder->registry_prev;
+    da_registry_release();
+}
+
+/* Capacity left after trimming to length plus slack_percent */
+static da_int_t da_trim_target(da_int_t length, da_int_t capacity, const da_trim_policy* policy) {
+    da_int_t slack = policy ? (da_int_t)((double)length * policy->slack_percent / 100.0) : 0;
+    if (slack < 0 || slack > capacity - length) return capacity;
+    return length + slack;
+}
+#endif
+
+/* Over-aligned storage: over-allocate, round up, and keep the raw pointer just below the block */
+static size_t da_aligned_overhead(int alignment) {
+    return (size_t)alignment + sizeof(void*);
+}
+
+static void* da_aligned_alloc(const da_allocator* allocator, int alignment, size_t bytes) {
+    char* raw = (char*)da_mem_alloc(allocator, bytes + da_aligned_overhead(alignment));
+    if (!raw) return NULL;
+    uintptr_t aligned = ((uintptr_t)raw + sizeof(void*) + (uintptr_t)alignment - 1) & ~((uintptr_t)alignment - 1);
+    ((void**)aligned)[-1] = raw;
+    return (void*)aligned;
+}
+
+static void da_aligned_free(const da_allocator* allocator, int alignment, void* ptr, size_t bytes) {
+    da_mem_free(allocator, ((void**)ptr)[-1], bytes + da_aligned_overhead(alignment));
+}
+
+/* Element storage: class-sized and cached on the default allocator, otherwise straight to the allocator.
+ * alignment > DA_DEFAULT_ALIGNMENT selects the over-aligned path (mmap pages already satisfy it). */
+static void* da_data_alloc(const da_allocator* allocator, int alignment, size_t bytes) {
+#if DA_HAS_MMAP
+    if (!allocator && bytes >= DA_MMAP_THRESHOLD) return da_mmap_alloc(bytes);
+#endif
+    if (alignment > (int)DA_DEFAULT_ALIGNMENT) return da_aligned_alloc(allocator, alignment, bytes);
+#if DA_BUFFER_CACHE_BYTES > 0
+    if (!allocator) {
+        int cls = da_bufcache_class(bytes);
+        if (cls >= 0) {
+            void* cached = da_bufcache_take(cls);
+            return cached ? cached : DA_MALLOC(da_bufcache_class_bytes(cls));
+        }
+    }
+#endif
+    return da_mem_alloc(allocator, bytes);
+}
+
+static void da_data_free(const da_allocator* allocator, int alignment, void* ptr, size_t bytes) {
+#if DA_HAS_MMAP
+    if (!allocator && bytes >= DA_MMAP_THRESHOLD) {
+        da_mmap_free(ptr, bytes);
+        return;
+    }
+#endif
+    if (alignment > (int)DA_DEFAULT_ALIGNMENT) {
+        da_aligned_free(allocator, alignment, ptr, bytes);
+        return;
+    }
+#if DA_BUFFER_CACHE_BYTES > 0
+    if (!allocator) {
+        int cls = da_bufcache_class(bytes);
+        if (cls >= 0 && da_bufcache_stats.cached_bytes + da_bufcache_class_bytes(cls) <= DA_BUFFER_CACHE_BYTES) {
+            da_pool_node* node = (da_pool_node*)ptr;
+            node->next = da_bufcache_lists[cls];
+            da_bufcache_lists[cls] = node;
+            da_bufcache_stats.cached_bytes += da_bufcache_class_bytes(cls);
+            da_bufcache_stats.recycled++;
+            return;
+        }
+        if (cls >= 0) da_bufcache_stats.overflows++;
+    }
+#endif
+    da_mem_free(allocator, ptr, bytes);
+}
+
+static void* da_data_realloc(const da_allocator* allocator, int alignment, void* ptr, size_t old_size,
+                             size_t new_size) {
+#if DA_HAS_MMAP
+    if (!allocator && (old_size >= DA_MMAP_THRESHOLD || new_size >= DA_MMAP_THRESHOLD)) {
+        if (!ptr) return da_data_alloc(allocator, alignment, new_size);  /* first allocation may be huge */
+        if (old_size >= DA_MMAP_THRESHOLD && new_size >= DA_MMAP_THRESHOLD) {
+            return da_mmap_resize(ptr, old_size, new_size);
+        }
+        /* Crossing the threshold: move between heap and mapping */
+        void* fresh = da_data_alloc(allocator, alignment, new_size);
+        if (fresh) {
+            memcpy(fresh, ptr, old_size < new_size ? old_size : new_size);
+            da_data_free(allocator, alignment, ptr, old_size);
+        }
+        return fresh;
+    }
+#endif
+    if (alignment > (int)DA_DEFAULT_ALIGNMENT) {
+        /* realloc cannot preserve the alignment: aligned allocation plus copy */
+        void* fresh = da_data_alloc(allocator, alignment, new_size);
+        if (fresh && ptr) {
+            memcpy(fresh, ptr, old_size < new_size ? old_size : new_size);
+            da_data_free(allocator, alignment, ptr, old_size);
+        }
+        return fresh;
+    }
+#if DA_BUFFER_CACHE_BYTES > 0
+    if (!allocator) {
+        if (!ptr) return da_data_alloc(allocator, alignment, new_size);
+
+        int old_cls = da_bufcache_class(old_size);
+        int new_cls = da_bufcache_class(new_size);
+        if (old_cls >= 0 && old_cls == new_cls) return ptr;  /* same class: already big enough */
+
+        if (new_cls >= 0) {
+            void* cached = da_bufcache_take(new_cls);
+            if (cached) {
+                memcpy(cached, ptr, old_size < new_size ? old_size : new_size);
+                da_data_free(allocator, alignment, ptr, old_size);
+                return cached;
+            }
+            return DA_REALLOC(ptr, da_bufcache_class_bytes(new_cls));
+        }
+        return DA_REALLOC(ptr, new_size);
+    }
+#endif
+    return da_mem_realloc(allocator, ptr, old_size, new_size);
+}
+
+/* Bytes usable in a data buffer allocated for the given size (at least bytes) */
+static size_t da_data_usable(const da_allocator* allocator, int alignment, void* ptr, size_t bytes) {
+    size_t usable = bytes;
+
+    if (alignment > (int)DA_DEFAULT_ALIGNMENT) return bytes;  /* the raw block is offset; keep it simple */
+    if (allocator) {
+        if (allocator->usable_size_fn) usable = allocator->usable_size_fn(allocator->context, ptr, bytes);
+        return usable > bytes ? usable : bytes;
+    }
+#if DA_USE_USABLE_SIZE
+#if DA_HAS_MMAP
+    if (bytes >= DA_MMAP_THRESHOLD) return da_page_round(bytes);
+#endif
+#if DA_BUFFER_CACHE_BYTES > 0
+    int cls = da_bufcache_class(bytes);
+    if (cls >= 0) {
+        usable = da_bufcache_class_bytes(cls);  /* must stay in the class it is cached under */
+    } else
+#endif
+    {
+#ifdef DA_MALLOC_USABLE_SIZE
+        usable = DA_MALLOC_USABLE_SIZE(ptr);
+#endif
+    }
+#if DA_HAS_MMAP
+    if (usable >= DA_MMAP_THRESHOLD) usable = DA_MMAP_THRESHOLD - 1;  /* must keep being freed to the heap */
+#endif
+#else
+    (void)ptr;
+#endif
+    return usable > bytes ? usable : bytes;
+}
+
+/* Capacity that fills the usable size of a heap buffer holding capacity elements */
+static da_int_t da_slack_capacity(const da_allocator* allocator, int alignment, void* data, da_int_t capacity,
+                                  da_int_t element_size) {
+    size_t usable = da_data_usable(allocator, alignment, data, (size_t)capacity * element_size);
+    if (usable > (size_t)DA_INT_MAX) usable = (size_t)DA_INT_MAX;
+    da_int_t fits = (da_int_t)(usable / (size_t)element_size);
+    return fits > capacity ? fits : capacity;
+}
+
+DA_DEF da_buffer_cache_stats da_buffer_cache_get_stats(void) {
+#if DA_BUFFER_CACHE_BYTES > 0
+    return da_bufcache_stats;
+#else
+    da_buffer_cache_stats empty = {0, 0, 0, 0, 0};
+    return empty;
+#endif
+}
+
+DA_DEF size_t da_buffer_cache_trim(size_t max_bytes) {
+    size_t released = 0;
+#if DA_BUFFER_CACHE_BYTES > 0
+    for (int cls = DA_BUFCACHE_CLASSES - 1; cls >= 0 && da_bufcache_stats.cached_bytes > max_bytes; cls--) {
+        while (da_bufcache_lists[cls] && da_bufcache_stats.cached_bytes > max_bytes) {
+            da_pool_node* node = da_bufcache_lists[cls];
+            da_bufcache_lists[cls] = node->next;
+            DA_FREE(node);
+            da_bufcache_stats.cached_bytes -= da_bufcache_class_bytes(cls);
+            released += da_bufcache_class_bytes(cls);
+        }
+    }
+    if (max_bytes == 0) {
+        memset(&da_bufcache_stats, 0, sizeof(da_bufcache_stats));
+    }
+#else
+    (void)max_bytes;
+#endif
+    return released;
+}
+
+#if DA_SHARED_EMPTY
+/* One immortal empty header per element size; never allocated, counted, or freed.
+ * Zero-initialized (designated initializers are not C++) and filled in on first use. */
+static da_array_t da_shared_empty_arrays[DA_SHARED_EMPTY_MAX_ELEMENT_SIZE];
+
+static da_array da_shared_empty_get(da_int_t element_size) {
+    da_array empty = &da_shared_empty_arrays[element_size - 1];
+    if (DA_UNLIKELY(empty->element_size == 0)) {
+        empty->element_size = element_size;  /* racing first uses store the same values */
+        DA_ATOMIC_STORE(&empty->ref_count, 1);
+    }
+    return empty;
+}
+
+static int da_is_shared_empty(da_array arr) {
+    uintptr_t p = (uintptr_t)arr;
+    return p >= (uintptr_t)da_shared_empty_arrays &&
+           p < (uintptr_t)(da_shared_empty_arrays + DA_SHARED_EMPTY_MAX_ELEMENT_SIZE);
+}
+
+/* The sentinel for an empty result shaped like arr, or NULL if arr's settings would be lost */
+static da_array da_shared_empty_like(da_array arr) {
+    if (arr->element_size > DA_SHARED_EMPTY_MAX_ELEMENT_SIZE || arr->retain_fn || arr->release_fn ||
+        arr->allocator || arr->alignment || arr->growth) {
+        return NULL;
+    }
+    return da_shared_empty_get(arr->element_size);
+}
+#else
+#define da_is_shared_empty(arr) 0
+#endif
+
+/* Size of the header block for a given in-block capacity */
+static size_t da_header_bytes(da_int_t element_size, da_int_t inline_capacity) {
+#if DA_SINGLE_ALLOC
+    if (inline_capacity == 0) return sizeof(da_array_t);  /* bare header, no tail */
+    size_t block_bytes = DA_INLINE_OFFSET + da_bytes(inline_capacity, element_size);
+    return block_bytes < sizeof(da_array_t) ? sizeof(da_array_t) : block_bytes;
+#else
+    (void)element_size;
+    (void)inline_capacity;
+    return sizeof(da_array_t);
+#endif
+}
+
+/* Allocates a header with room for capacity elements, length = 0 */
+static da_array da_make_array(da_int_t element_size, da_int_t capacity, void (*retain_fn)(void*), void (*release_fn)(void*),
+                              const da_allocator* allocator, int alignment) {
+    da_int_t inline_capacity = DA_SBO_BYTES / element_size;  /* 0 without a small buffer */
+
+    if (alignment > (int)DA_DEFAULT_ALIGNMENT) {
+        inline_capacity = 0;  /* the header block cannot guarantee the alignment */
+    }
+#if DA_SINGLE_ALLOC
+    /* Extend the in-block storage to hold the requested capacity */
+    else if (capacity > inline_capacity) inline_capacity = capacity;
+#endif
+    da_array arr = (da_array)da_header_alloc(allocator, da_header_bytes(element_size, inline_capacity));
+    DA_ASSERT(arr != NULL);
+    arr->allocator = allocator;
+    arr->growth = NULL;
+    arr->alignment = alignment;
+#if DA_COW
+    arr->shared = NULL;
+#endif
+
+#if DA_HAS_INLINE_STORAGE
+    arr->inline_capacity = inline_capacity;
+#endif
+
+    if (capacity == 0) {
+        arr->data = NULL;  /* Deferred allocation */
+    } else if (capacity <= inline_capacity) {
+#if DA_HAS_INLINE_STORAGE
+        arr->data = da_inline_data(arr);
+#endif
+    } else {
+        arr->data = da_data_alloc(allocator, alignment, da_bytes(capacity, element_size));
+        DA_ASSERT(arr->data != NULL);
+    }
+
+    DA_ATOMIC_STORE(&arr->ref_count, 1);
+    arr->length = 0;
+    arr->capacity = capacity;
+    arr->element_size = element_size;
+    arr->retain_fn = retain_fn;
+    arr->release_fn = release_fn;
+
+#if DA_REGISTRY
+    da_registry_add_array(arr);
+#endif
+    return arr;
+}
+
+/* Frees element storage (not the elements themselves); data becomes NULL */
+static void da_storage_free(da_array arr) {
+    if (arr->data && !da_data_is_inline(arr)) {
+        da_data_free(arr->allocator, arr->alignment, arr->data, (size_t)arr->capacity * arr->element_size);
+    }
+    arr->data = NULL;
+}
+
+#if DA_COW
+static void da_storage_resize(da_array arr, da_int_t new_capacity);
+
+/* Releases the elements of a shared buffer nobody references any more, then the buffer itself */
+static void da_cow_free_buffer(da_array arr, void* data, da_shared_buffer* shared) {
+    if (arr->release_fn) {
+        for (da_int_t i = 0; i < arr->length; i++) {
+            arr->release_fn((char*)data + (i * arr->element_size));
+        }
+    }
+    da_data_free(arr->allocator, arr->alignment, data, (size_t)shared->capacity * arr->element_size);
+    da_mem_free(arr->allocator, shared, sizeof(da_shared_buffer));
+}
+
+/* Drops arr's share of its buffer without copying; data becomes NULL */
+static void da_cow_drop(da_array arr) {
+    da_shared_buffer* shared = arr->shared;
+    arr->shared = NULL;
+    if (DA_ATOMIC_FETCH_SUB(&shared->ref_count, 1) == 1) {
+        da_cow_free_buffer(arr, arr->data, shared);
+    }
+    arr->data = NULL;
+    arr->capacity = 0;
+}
+
+/* Ends arr's share of its buffer, leaving it private storage of new_capacity elements
+ * (-1: keep the buffer if nobody else holds it, otherwise copy to exactly length) */
+static void da_cow_detach(da_array arr, da_int_t new_capacity) {
+    da_shared_buffer* shared = arr->shared;
+    void* data = arr->data;
+    arr->shared = NULL;
+
+    if (DA_ATOMIC_LOAD(&shared->ref_count) == 1) {
+        /* Every other sharer has moved on: the buffer is ours */
+        arr->capacity = shared->capacity;
+        da_mem_free(arr->allocator, shared, sizeof(da_shared_buffer));
+        if (new_capacity >= 0 && new_capacity != arr->capacity) {
+            da_storage_resize(arr, new_capacity);
+        }
+        return;
+    }
+
+    arr->data = NULL;
+    arr->capacity = 0;
+    da_storage_resize(arr, new_capacity < 0 ? arr->length : new_capacity);
+    memcpy(arr->data, data, (size_t)arr->length * arr->element_size);
+    if (arr->retain_fn) {
+        for (da_int_t i = 0; i < arr->length; i++) {
+            arr->retain_fn((char*)arr->data + (i * arr->element_size));
+        }
+    }
+    if (DA_ATOMIC_FETCH_SUB(&shared->ref_count, 1) == 1) {
+        da_cow_free_buffer(arr, data, shared);  /* the others let go while we copied */
+    }
+}
+#endif
+
+/* Moves storage to exactly new_capacity elements, preserving the first length elements */
+static void da_storage_resize(da_array arr, da_int_t new_capacity) {
+    DA_ASSERT(new_capacity >= arr->length);
+    DA_CHECK_MUTABLE(arr);  /* read-only: da_ensure_mutable() first */
+#if DA_COW
+    if (arr->shared) {
+        da_cow_detach(arr, new_capacity);
+        return;
+    }
+#endif
+
+    if (new_capacity == 0) {
+        da_storage_free(arr);
+        arr->capacity = 0;
+        return;
+    }
+
+    size_t bytes = da_bytes(new_capacity, arr->element_size);
+
+#if DA_HAS_INLINE_STORAGE
+    void* home = da_inline_data(arr);
+
+    if (new_capacity <= da_inline_limit(arr)) {
+        /* Fits in the header block: move home if currently on the heap */
+        if (arr->data != home) {
+            if (arr->data) {
+                memcpy(home, arr->data, (size_t)arr->length * arr->element_size);
+                da_data_free(arr->allocator, arr->alignment, arr->data, (size_t)arr->capacity * arr->element_size);
+            }
+            arr->data = home;
+        }
+        arr->capacity = new_capacity;
+        return;
+    }
+
+    if (da_data_is_inline(arr)) {
+        /* Outgrew the header block: the header cannot move, so spill to the heap */
+        void* heap = da_data_alloc(arr->allocator, arr->alignment, bytes);
+        DA_ASSERT(heap != NULL);
+        memcpy(heap, home, (size_t)arr->length * arr->element_size);
+        arr->data = heap;
+        arr->capacity = new_capacity;
+        return;
+    }
+#endif
+
+    arr->data = da_data_realloc(arr->allocator, arr->alignment, arr->data, (size_t)arr->capacity * arr->element_size,
+                                bytes);
+    DA_ASSERT(arr->data != NULL);
+    arr->capacity = new_capacity;
+}
+
+/* After growth: claim the allocator's slack beyond the requested capacity */
+static void da_storage_claim_slack(da_array arr) {
+    if (!arr->data) return;
+#if DA_HAS_INLINE_STORAGE
+    if (da_data_is_inline(arr)) return;
+#endif
+    arr->capacity = da_slack_capacity(arr->allocator, arr->alignment, arr->data, arr->capacity, arr->element_size);
+}
+
+/* Normalizes a requested alignment: 0 stands for the allocator default */
+static int da_check_alignment(int alignment) {
+    DA_ASSERT(alignment > 0 && alignment <= DA_MAX_ALIGNMENT);
+    DA_ASSERT((alignment & (alignment - 1)) == 0);  /* power of two */
+    return alignment > (int)DA_DEFAULT_ALIGNMENT ? alignment : 0;
+}
+
+/* Moves existing storage into a buffer allocated for a new alignment */
+static void* da_storage_realign(const da_allocator* allocator, void* data, int old_alignment, int new_alignment,
+                                size_t bytes, size_t used, int data_is_inline) {
+    if (!data) return NULL;
+    void* fresh = da_data_alloc(allocator, new_alignment, bytes);
+    DA_ASSERT(fresh != NULL);
+    memcpy(fresh, data, used);
+    if (!data_is_inline) {
+        da_data_free(allocator, old_alignment, data, bytes);
+    }
+    return fresh;
+}
+
+/* Frees the header block (storage must already be freed) */
+static void da_header_free(da_array arr) {
+#if DA_HAS_INLINE_STORAGE
+    size_t header_bytes = da_header_bytes(arr->element_size, arr->inline_capacity);
+#else
+    size_t header_bytes = sizeof(da_array_t);
+#endif
+    da_header_dealloc(arr->allocator, arr, header_bytes);
+}
+
+/* Array Implementation */
+
+DA_DEF da_array da_new(da_int_t element_size) {
+    DA_ASSERT(element_size > 0);
+
+    return da_make_array(element_size, 0, NULL, NULL, NULL, 0);  /* Deferred allocation */
+}
+
+DA_DEF da_array da_create(da_int_t element_size, da_int_t initial_capacity, void (*retain_fn)(void*), void (*release_fn)(void*)) {
+    DA_ASSERT(element_size > 0);
+    DA_ASSERT(initial_capacity >= 0);
+
+    da_array arr = da_make_array(element_size, initial_capacity, retain_fn, release_fn, NULL, 0);
+    da_storage_claim_slack(arr);
+    return arr;
+}
+
+DA_DEF da_array da_create_with_allocator(da_int_t element_size, da_int_t initial_capacity, void (*retain_fn)(void*),
+                                         void (*release_fn)(void*), const da_allocator* allocator) {
+    DA_ASSERT(element_size > 0);
+    DA_ASSERT(initial_capacity >= 0);
+    DA_ASSERT(allocator == NULL || (allocator->alloc_fn != NULL && allocator->free_fn != NULL));
+
+    da_array arr = da_make_array(element_size, initial_capacity, retain_fn, release_fn, allocator, 0);
+    da_storage_claim_slack(arr);
+    return arr;
+}
+
+DA_DEF da_array da_create_aligned(da_int_t element_size, da_int_t initial_capacity, void (*retain_fn)(void*),
+                                  void (*release_fn)(void*), int alignment) {
+    DA_ASSERT(element_size > 0);
+    DA_ASSERT(initial_capacity >= 0);
+
+    return da_make_array(element_size, initial_capacity, retain_fn, release_fn, NULL, da_check_alignment(alignment));
+}
+
+DA_DEF void da_set_growth(da_array arr, const da_growth_policy* policy) {
+    DA_ASSERT(arr != NULL);
+    DA_CHECK_MUTABLE(arr);
+    arr->growth = policy;
+}
+
+DA_DEF void da_set_alignment(da_array arr, int alignment) {
+    DA_ASSERT(arr != NULL);
+    DA_CHECK_MUTABLE(arr);
+    DA_COW_UNSHARE(arr);
+
+    int normalized = da_check_alignment(alignment);
+    if (normalized == arr->alignment) return;
+
+    arr->data = da_storage_realign(arr->allocator, arr->data, arr->alignment, normalized,
+                                   (size_t)arr->capacity * arr->element_size,
+                                   (size_t)arr->length * arr->element_size, da_data_is_inline(arr));
+    arr->alignment = normalized;
+}
+
+DA_DEF void da_release(da_array* arr) {
+    DA_ASSERT(arr != NULL);
+    DA_ASSERT(*arr != NULL);
+
+    if (da_is_shared_empty(*arr)) {  /* immortal */
+        *arr = NULL;
+        return;
+    }
+
+    int old_count = DA_ATOMIC_FETCH_SUB(&(*arr)->ref_count, 1);
+
+    if (old_count == 1) {  /* We were the last reference */
+#if DA_REGISTRY
+        da_registry_remove_array(*arr);  /* before anything is freed, so da_trim_all never sees it half-gone */
+#endif
+#if DA_COW
+        if ((*arr)->shared) {
+            da_cow_drop(*arr);  /* the elements belong to the buffer, not to this array */
+        }
+#endif
+        if ((*arr)->data && (*arr)->release_fn) {
+            /* Call release function on each element before freeing */
+            for (da_int_t i = 0; i < (*arr)->length; i++) {
+                void* element_ptr = (char*)(*arr)->data + (i * (*arr)->element_size);
+                (*arr)->release_fn(element_ptr);
+            }
+        }
+        da_storage_free(*arr);
+        da_header_free(*arr);
+    }
+
+    *arr = NULL;  /* Always NULL the pointer for safety */
+}
+
+DA_DEF da_array da_retain(da_array arr) {
+    DA_ASSERT(arr != NULL);
+    if (!da_is_shared_empty(arr)) {
+        DA_ATOMIC_FETCH_ADD(&arr->ref_count, 1);
+    }
+    return arr;
+}
+
+DA_DEF da_array da_empty(da_int_t element_size) {
+    DA_ASSERT(element_size > 0);
+#if DA_SHARED_EMPTY
+    if (element_size <= DA_SHARED_EMPTY_MAX_ELEMENT_SIZE) {
+        return da_shared_empty_get(element_size);
+    }
+#endif
+    return da_new(element_size);
+}
+
+DA_DEF void da_unshare(da_array arr) {
+    DA_ASSERT(arr != NULL);
+#if DA_COW
+    if (arr->shared) {
+        da_cow_detach(arr, -1);
+    }
+#else
+    (void)arr;
+#endif
+}
+
+DA_DEF da_array da_ensure_mutable(da_array* arr) {
+    DA_ASSERT(arr != NULL);
+    DA_ASSERT(*arr != NULL);
+    if (da_is_shared_empty(*arr)) {
+        *arr = da_new((*arr)->element_size);
+    }
+    return *arr;
+}
+
+DA_DEF void da_check_mutable(da_array arr) {
+    DA_ASSERT(arr != NULL);
+#if DA_SHARED_EMPTY
+    if (da_is_shared_empty(arr)) {
+        DA_ASSERT(!"mutating a shared empty array; call da_ensure_mutable() first");
+        abort();  /* not just an assert: the write would leak into every later empty result */
+    }
+#else
+    (void)arr;
+#endif
+}
+
+DA_DEF void da_set(da_array arr, da_int_t index, const void* element) {
+    DA_ASSERT(arr != NULL);
+    DA_ASSERT(element != NULL);
+    DA_ASSERT(index >= 0 && index < arr->length);
+    DA_CHECK_MUTABLE(arr);
+    DA_COW_UNSHARE(arr);
+
+    void* dest = (char*)arr->data + (index * arr->element_size);
+    
+    /* Call release function on the old element before overwriting */
+    if (arr->release_fn) {
+        arr->release_fn(dest);
+    }
+    
+    memcpy(dest, element, arr->element_size);
+    
+    /* Call retain function on the newly set element */
+    if (arr->retain_fn) {
+        arr->retain_fn(dest);
+    }
+}
+
+DA_DEF void da_insert(da_array arr, da_int_t index, const void* element) {
+    DA_ASSERT(arr != NULL);
+    DA_ASSERT(element != NULL);
+    DA_ASSERT(index >= 0 && index <= arr->length);
+    DA_CHECK_MUTABLE(arr);
+
+    /* Grow array if needed */
+    if (arr->length >= arr->capacity) {
+        da_grow(arr, arr->length + 1);
+    }
+
+    /* Shift elements to the right if not inserting at the end */
+    if (index < arr->length) {
+        void* src = (char*)arr->data + (index * arr->element_size);
+        void* dest = (char*)arr->data + ((index + 1) * arr->element_size);
+        size_t bytes_to_move = (size_t)(arr->length - index) * arr->element_size;
+        memmove(dest, src, bytes_to_move);
+    }
+
+    /* Insert the new element */
+    void* insert_pos = (char*)arr->data + (index * arr->element_size);
+    memcpy(insert_pos, element, arr->element_size);
+    
+    /* Call retain function on the newly inserted element */
+    if (arr->retain_fn) {
+        arr->retain_fn(insert_pos);
+    }
+    
+    arr->length++;
+}
+
+DA_DEF void da_remove(da_array arr, da_int_t index, void* out) {
+    DA_ASSERT(arr != NULL);
+    DA_ASSERT(index >= 0 && index < arr->length);
+    DA_CHECK_MUTABLE(arr);
+    DA_COW_UNSHARE(arr);
+
+    void* element_ptr = (char*)arr->data + (index * arr->element_size);
+    
+    /* Copy element to output if requested */
+    if (out != NULL) {
+        memcpy(out, element_ptr, arr->element_size);
+    }
+    
+    /* Call destructor on the removed element */
+    if (arr->release_fn) {
+        arr->release_fn(element_ptr);
+    }
+
+    /* Shift elements to the left if not removing the last element */
+    if (index < arr->length - 1) {
+        void* dest = (char*)arr->data + (index * arr->element_size);
+        void* src = (char*)arr->data + ((index + 1) * arr->element_size);
+        size_t bytes_to_move = (size_t)(arr->length - index - 1) * arr->element_size;
+        memmove(dest, src, bytes_to_move);
+    }
+
+    arr->length--;
+    da_auto_shrink(arr);
+}
+
+DA_DEF void da_pop(da_array arr, void* out) {
+    DA_ASSERT(arr != NULL);
+    DA_ASSERT(arr->length > 0);
+    DA_CHECK_MUTABLE(arr);
+    DA_COW_UNSHARE(arr);
+
+    arr->length--;
+
+    void* src = (char*)arr->data + (arr->length * arr->element_size);
+    if (out != NULL) {
+        memcpy(out, src, arr->element_size);
+    }
+    
+    /* Call release function on the popped element */
+    if (arr->release_fn) {
+        arr->release_fn(src);
+    }
+    da_auto_shrink(arr);
+}
+
+DA_DEF void da_clear(da_array arr) {
+    DA_ASSERT(arr != NULL);
+    if (da_is_shared_empty(arr)) return;  /* already empty; the header is shared */
+#if DA_COW
+    if (arr->shared) {
+        da_cow_drop(arr);  /* nothing to copy when every element goes */
+        arr->length = 0;
+        return;
+    }
+#endif
+
+    /* Call release function on all elements before clearing */
+    if (arr->release_fn && arr->data) {
+        for (da_int_t i = 0; i < arr->length; i++) {
+            void* element_ptr = (char*)arr->data + (i * arr->element_size);
+            arr->release_fn(element_ptr);
+        }
+    }
+    
+    arr->length = 0;
+    da_auto_shrink(arr);
+}
+
+DA_DEF void da_reserve(da_array arr, da_int_t new_capacity) {
+    DA_ASSERT(arr != NULL);
+    DA_ASSERT(new_capacity >= 0);
+
+    if (new_capacity > arr->capacity) {
+        da_storage_resize(arr, new_capacity);
+    }
+}
+
+DA_DEF void da_grow(da_array arr, da_int_t min_capacity) {
+    DA_ASSERT(arr != NULL);
+    DA_ASSERT(min_capacity >= 0);
+
+    if (min_capacity > arr->capacity) {
+        da_storage_resize(arr, da_grow_capacity(arr, min_capacity));
+        da_storage_claim_slack(arr);
+    }
+}
+
+DA_DEF void da_auto_shrink(da_array arr) {
+    DA_ASSERT(arr != NULL);
+
+    const da_growth_policy* policy = arr->growth;
+    if (!policy || policy->shrink_divisor == 0) return;
+    DA_ASSERT(policy->shrink_divisor > 2);  /* <= 2 would shrink right back into the growth threshold */
+    if (arr->length >= arr->capacity / policy->shrink_divisor) return;
+
+    da_int_t target = arr->length > DA_INT_MAX / 2 ? arr->length : arr->length * 2;
+    if (target < policy->shrink_min_capacity) target = policy->shrink_min_capacity;
+    if (target < arr->capacity) {
+        da_storage_resize(arr, target);
+    }
+}
+
+DA_DEF void da_resize(da_array arr, da_int_t new_length) {
+    DA_ASSERT(arr != NULL);
+    DA_ASSERT(new_length >= 0);
+    DA_CHECK_MUTABLE(arr);
+    DA_COW_UNSHARE(arr);
+
+    if (new_length > arr->capacity) {
+        da_reserve(arr, new_length);
+    }
+
+    if (new_length < arr->length) {
+        /* Call destructor on elements being removed */
+        if (arr->release_fn && arr->data) {
+            for (da_int_t i = new_length; i < arr->length; i++) {
+                void* element_ptr = (char*)arr->data + (i * arr->element_size);
+                arr->release_fn(element_ptr);
+            }
+        }
+    } else if (new_length > arr->length) {
+        /* Zero-fill new elements */
+        void* start = (char*)arr->data + (arr->length * arr->element_size);
+        size_t bytes_to_zero = (size_t)(new_length - arr->length) * arr->element_size;
+        memset(start, 0, bytes_to_zero);
+    }
+
+    arr->length = new_length;
+}
+
+DA_DEF void da_trim(da_array arr, da_int_t new_capacity) {
+    DA_ASSERT(arr != NULL);
+    DA_ASSERT(new_capacity >= arr->length);
+
+    if (new_capacity < arr->capacity) {
+        da_storage_resize(arr, new_capacity);
+    }
+}
+
+DA_DEF void da_append_array(da_array dest, da_array src) {
+    DA_ASSERT(dest != NULL);
+    DA_ASSERT(src != NULL);
+    DA_ASSERT(dest->element_size == src->element_size);
+
+    if (src->length == 0) return;  /* Nothing to append */
+
+    /* Ensure dest has enough capacity */
+    da_int_t new_length = da_add_length(dest->length, src->length);
+    if (new_length > dest->capacity) {
+        da_grow(dest, new_length);
+    }
+
+    /* Copy all elements from src to end of dest */
+    void* dest_ptr = (char*)dest->data + (dest->length * dest->element_size);
+    memcpy(dest_ptr, src->data, src->length * src->element_size);
+    
+    /* Call retain function on all copied elements */
+    if (dest->retain_fn) {
+        for (da_int_t i = dest->length; i < new_length; i++) {
+            void* element_ptr = (char*)dest->data + (i * dest->element_size);
+            dest->retain_fn(element_ptr);
+        }
+    }
+    
+    dest->length = new_length;
+}
+
+DA_DEF da_array da_concat(da_array arr1, da_array arr2) {
+    DA_ASSERT(arr1 != NULL);
+    DA_ASSERT(arr2 != NULL);
+    DA_ASSERT(arr1->element_size == arr2->element_size);
+
+    da_int_t total_length = da_add_length(arr1->length, arr2->length);
+#if DA_SHARED_EMPTY
+    if (total_length == 0 && da_shared_empty_like(arr1)) return da_shared_empty_like(arr1);
+#endif
+
+    /* Create new array with exact capacity, inheriting retain/release, allocator and alignment from the first array */
+    da_array result = da_make_array(arr1->element_size, total_length, arr1->retain_fn, arr1->release_fn,
+                                      arr1->allocator, arr1->alignment);
+    result->length = total_length;
+    result->growth = arr1->growth;
+
+    if (total_length > 0) {
+        /* Copy arr1 elements first */
+        if (arr1->length > 0) {
+            memcpy(result->data, arr1->data, arr1->length * result->element_size);
+        }
+
+        /* Copy arr2 elements after arr1 */
+        if (arr2->length > 0) {
+            void* dest_ptr = (char*)result->data + (arr1->length * result->element_size);
+            memcpy(dest_ptr, arr2->data, arr2->length * result->element_size);
+        }
+        
+        /* Call retain function on all copied elements */
+        if (result->retain_fn) {
+            for (da_int_t i = 0; i < result->length; i++) {
+                void* element_ptr = (char*)result->data + (i * result->element_size);
+                result->retain_fn(element_ptr);
+            }
+        }
+    }
+
+    return result;
+}
+
+/* Builder Implementation */
+
+/* Moves builder storage to exactly new_capacity elements */
+static void da_builder_storage_resize(da_builder builder, da_int_t new_capacity) {
+    builder->data = da_data_realloc(builder->allocator, builder->alignment, builder->data,
+                                    (size_t)builder->capacity * builder->element_size,
+                                    da_bytes(new_capacity, builder->element_size));
+    DA_ASSERT(builder->data != NULL);
+    builder->capacity = new_capacity;
+}
+
+/* Growth only: claim the allocator's slack beyond the requested capacity */
+static void da_builder_storage_grow(da_builder builder, da_int_t new_capacity) {
+    da_builder_storage_resize(builder, new_capacity);
+    builder->capacity = da_slack_capacity(builder->allocator, builder->alignment, builder->data, builder->capacity,
+                                          builder->element_size);
+}
+
+/* Frees builder storage and the builder itself */
+static void da_builder_free(da_builder builder) {
+#if DA_REGISTRY
+    da_registry_remove_builder(builder);
+#endif
+    if (builder->data) {
+        da_data_free(builder->allocator, builder->alignment, builder->data,
+                     (size_t)builder->capacity * builder->element_size);
+    }
+    da_builder_header_dealloc(builder);
+}
+
+DA_DEF da_builder da_builder_create(da_int_t element_size) {
+    return da_builder_create_with_allocator(element_size, NULL);
+}
+
+DA_DEF da_builder da_builder_create_with_allocator(da_int_t element_size, const da_allocator* allocator) {
+    DA_ASSERT(element_size > 0);
+    DA_ASSERT(allocator == NULL || (allocator->alloc_fn != NULL && allocator->free_fn != NULL));
+
+    da_builder builder = da_builder_header_alloc(allocator);
+    DA_ASSERT(builder != NULL);
+
+    builder->length = 0;
+    builder->capacity = 0;
+    builder->element_size = element_size;
+    builder->data = NULL;
+    builder->allocator = allocator;
+    builder->growth = NULL;
+    builder->alignment = 0;
+#if DA_REGISTRY
+    da_registry_add_builder(builder);
+#endif
+
+    return builder;
+}
+
+DA_DEF void da_builder_set_growth(da_builder builder, const da_growth_policy* policy) {
+    DA_ASSERT(builder != NULL);
+    builder->growth = policy;
+}
+
+DA_DEF void da_builder_set_alignment(da_builder builder, int alignment) {
+    DA_ASSERT(builder != NULL);
+
+    int normalized = da_check_alignment(alignment);
+    if (normalized == builder->alignment) return;
+
+    builder->data = da_storage_realign(builder->allocator, builder->data, builder->alignment, normalized,
+                                       (size_t)builder->capacity * builder->element_size,
+                                       (size_t)builder->length * builder->element_size, 0);
+    builder->alignment = normalized;
+}
+
+DA_DEF void da_builder_append(da_builder builder, const void* element) {
+    DA_ASSERT(builder != NULL);
+    DA_ASSERT(element != NULL);
+
+    if (builder->length >= builder->capacity) {
+        da_builder_storage_grow(builder, da_builder_grow_capacity(builder, builder->length + 1));
+    }
+
+    void* dest = (char*)builder->data + (builder->length * builder->element_size);
+    memcpy(dest, element, builder->element_size);
+    builder->length++;
+}
+
+DA_DEF void da_builder_reserve(da_builder builder, da_int_t new_capacity) {
+    DA_ASSERT(builder != NULL);
+    DA_ASSERT(new_capacity >= 0);
+
+    if (new_capacity > builder->capacity) {
+        da_builder_storage_resize(builder, new_capacity);
+    }
+}
+
+DA_DEF void da_builder_append_array(da_builder builder, da_array arr) {
+    DA_ASSERT(builder != NULL);
+    DA_ASSERT(arr != NULL);
+    DA_ASSERT(builder->element_size == arr->element_size);
+
+    if (arr->length == 0) return;  /* Nothing to append */
+
+    /* Ensure enough capacity */
+    da_int_t new_length = da_add_length(builder->length, arr->length);
+    if (new_length > builder->capacity) {
+        da_builder_storage_grow(builder, da_builder_grow_capacity(builder, new_length));
+    }
+
+    /* Copy all elements from array at once */
+    void* dest_ptr = (char*)builder->data + (builder->length * builder->element_size);
+    memcpy(dest_ptr, arr->data, arr->length * arr->element_size);
+    builder->length = new_length;
+}
+
+DA_DEF da_array da_builder_to_array(da_builder* builder, void (*retain_fn)(void*), void (*release_fn)(void*)) {
+    DA_ASSERT(builder != NULL);
+    DA_ASSERT(*builder != NULL);
+
+    da_builder b = *builder;
+
+    da_array arr;
+    if ((DA_SINGLE_ALLOC || b->length <= DA_SBO_BYTES / b->element_size) && b->alignment == 0) {
+        /* Copy into the header block (co-allocated tail or small buffer) and drop the builder's buffer */
+        arr = da_make_array(b->element_size, b->length, retain_fn, release_fn, b->allocator, b->alignment);
+        if (b->length > 0) {
+            memcpy(arr->data, b->data, b->length * b->element_size);
+        }
+    } else {
+        /* Adopt the builder's buffer, shrunk to exact size (capacity = length) */
+        da_builder_storage_resize(b, b->length);
+        arr = da_make_array(b->element_size, 0, retain_fn, release_fn, b->allocator, b->alignment);
+        arr->data = b->data;
+        arr->capacity = b->length;
+        b->data = NULL;
+    }
+    arr->length = b->length;
+    arr->growth = b->growth;
+
+    /* Call retain function on all elements in the new array */
+    if (arr->retain_fn) {
+        for (da_int_t i = 0; i < arr->length; i++) {
+            void* element_ptr = (char*)arr->data + (i * arr->element_size);
+            arr->retain_fn(element_ptr);
+        }
+    }
+
+    /* Free builder (and its buffer, unless adopted) */
+    da_builder_free(b);
+    *builder = NULL;
+
+    return arr;
+}
+
+DA_DEF void da_builder_clear(da_builder builder) {
+    DA_ASSERT(builder != NULL);
+    builder->length = 0;
+}
+
+DA_DEF void da_builder_destroy(da_builder* builder) {
+    DA_ASSERT(builder != NULL);
+    DA_ASSERT(*builder != NULL);
+
+    da_builder_free(*builder);
+    *builder = NULL;
+}
+
+DA_DEF da_int_t da_builder_length(da_builder builder) {
+    DA_ASSERT(builder != NULL);
+    return builder->length;
+}
+
+DA_DEF da_int_t da_builder_capacity(da_builder builder) {
+    DA_ASSERT(builder != NULL);
+    return builder->capacity;
+}
+
+DA_DEF void* da_builder_get(da_builder builder, da_int_t index) {
+    DA_ASSERT(builder != NULL);
+    DA_ASSERT(index >= 0 && index < builder->length);
+    return (char*)builder->data + (index * builder->element_size);
+}
+
+DA_DEF void da_builder_set(da_builder builder, da_int_t index, const void* element) {
+    DA_ASSERT(builder != NULL);
+    DA_ASSERT(element != NULL);
+    DA_ASSERT(index >= 0 && index < builder->length);
+
+    void* dest = (char*)builder->data + (index * builder->element_size);
+    memcpy(dest, element, builder->element_size);
+}
+
+/* Registry Implementation */
+
+DA_DEF size_t da_trim_all(const da_trim_policy* policy) {
+    size_t freed = 0;
+#if DA_REGISTRY
+    size_t min_slack = policy ? policy->min_slack_bytes : 0;
+
+    da_registry_acquire();
+    for (da_array arr = da_registry_arrays; arr; arr = arr->registry_next) {
+        if (!arr->data) continue;
+#if DA_HAS_INLINE_STORAGE
+        if (da_data_is_inline(arr)) continue;  /* lives in the header block: nothing to free */
+#endif
+        da_int_t target = da_trim_target(arr->length, arr->capacity, policy);
+        size_t slack = (size_t)(arr->capacity - target) * arr->element_size;
+        if (target >= arr->capacity || slack < min_slack) continue;
+
+        size_t before = (size_t)arr->capacity * arr->element_size;
+        da_storage_resize(arr, target);
+        int now_inline = 0;
+#if DA_HAS_INLINE_STORAGE
+        now_inline = da_data_is_inline(arr);
+#endif
+        freed += before - (arr->data && !now_inline ? (size_t)arr->capacity * arr->element_size : 0);
+    }
+    if (policy && policy->include_builders) {
+        for (da_builder b = da_registry_builders; b; b = b->registry_next) {
+            if (!b->data) continue;
+            da_int_t target = da_trim_target(b->length, b->capacity, policy);
+            size_t slack = (size_t)(b->capacity - target) * b->element_size;
+            if (target >= b->capacity || slack < min_slack) continue;
+
+            if (target == 0) {
+                da_data_free(b->allocator, b->alignment, b->data, (size_t)b->capacity * b->element_size);
+                b->data = NULL;
+                b->capacity = 0;
+            } else {
+                da_builder_storage_resize(b, target);
+            }
+            freed += slack;
+        }
+    }
+    da_registry_release();
+#else
+    (void)policy;
+#endif
+    return freed;
+}
+
+DA_DEF da_registry_stats da_registry_get_stats(void) {
+    da_registry_stats stats = {0, 0, 0, 0};
+#if DA_REGISTRY
+    da_registry_acquire();
+    for (da_array arr = da_registry_arrays; arr; arr = arr->registry_next) {
+        stats.arrays++;
+        int on_heap = arr->data != NULL;
+#if DA_HAS_INLINE_STORAGE
+        on_heap = on_heap && !da_data_is_inline(arr);
+#endif
+        if (on_heap) {
+            stats.capacity_bytes += (size_t)arr->capacity * arr->element_size;
+            stats.length_bytes += (size_t)arr->length * arr->element_size;
+        }
+    }
+    for (da_builder b = da_registry_builders; b; b = b->registry_next) {
+        stats.builders++;
+        stats.capacity_bytes += (size_t)b->capacity * b->element_size;
+        stats.length_bytes += (size_t)b->length * b->element_size;
+    }
+    da_registry_release();
+#endif
+    return stats;
+}
+
+DA_DEF void da_registry_for_each(void (*fn)(da_array arr, void* context), void* context) {
+    DA_ASSERT(fn != NULL);
+#if DA_REGISTRY
+    da_registry_acquire();
+    for (da_array arr = da_registry_arrays; arr; arr = arr->registry_next) {
+        fn(arr, context);
+    }
+    da_registry_release();
+#else
+    (void)fn;
+    (void)context;
+#endif
+}
+
+/* Arena Implementation */
+
+/* Arena allocations (and the chunk header) are aligned for any fundamental type */
+#define DA_ARENA_ALIGN (2 * sizeof(void*))
+#define DA_ARENA_ROUND(n) (((n) + DA_ARENA_ALIGN - 1) & ~(DA_ARENA_ALIGN - 1))
+#define DA_ARENA_CHUNK_HEADER DA_ARENA_ROUND(sizeof(da_arena_chunk))
+
+static char* da_arena_chunk_data(da_arena_chunk* chunk) {
+    return (char*)chunk + DA_ARENA_CHUNK_HEADER;
+}
+
+static void* da_arena_alloc_fn(void* context, size_t size) {
+    da_arena arena = (da_arena)context;
+    size_t aligned = DA_ARENA_ROUND(size > 0 ? size : 1);
+    da_arena_chunk* chunk = arena->current;
+
+    if (!chunk || chunk->used + aligned > chunk->size) {
+        if (chunk && chunk->next && aligned <= chunk->next->size) {
+            /* Reuse a chunk kept from before the last reset */
+            chunk = chunk->next;
+        } else {
+            size_t usable = aligned > arena->chunk_bytes ? aligned : arena->chunk_bytes;
+            da_arena_chunk* fresh = (da_arena_chunk*)DA_MALLOC(DA_ARENA_CHUNK_HEADER + usable);
+            DA_ASSERT(fresh != NULL);
+            fresh->size = usable;
+            fresh->used = 0;
+            if (chunk) {
+                fresh->next = chunk->next;
+                chunk->next = fresh;
+            } else {
+                fresh->next = arena->head;
+                arena->head = fresh;
+            }
+            chunk = fresh;
+        }
+        arena->current = chunk;
+    }
+
+    void* ptr = da_arena_chunk_data(chunk) + chunk->used;
+    chunk->used += aligned;
+    arena->last = ptr;
+    arena->last_size = aligned;
+    return ptr;
+}
+
+static void* da_arena_realloc_fn(void* context, void* ptr, size_t old_size, size_t new_size) {
+    da_arena arena = (da_arena)context;
+    if (!ptr) return da_arena_alloc_fn(context, new_size);
+
+    if (ptr == arena->last) {
+        /* Most recent allocation: grow or shrink in place if the chunk has room */
+        da_arena_chunk* chunk = arena->current;
+        size_t aligned = DA_ARENA_ROUND(new_size > 0 ? new_size : 1);
+        if (chunk->used - arena->last_size + aligned <= chunk->size) {
+            chunk->used = chunk->used - arena->last_size + aligned;
+            arena->last_size = aligned;
+            return ptr;
+        }
+    }
+
+    void* fresh = da_arena_alloc_fn(context, new_size);
+    memcpy(fresh, ptr, old_size < new_size ? old_size : new_size);
+    return fresh;
+}
+
+static void da_arena_free_fn(void* context, void* ptr, size_t size) {
+    da_arena arena = (da_arena)context;
+    (void)size;
+
+    /* Only the most recent allocation can be handed back; everything else waits for reset */
+    if (ptr == arena->last) {
+        arena->current->used -= arena->last_size;
+        arena->last = NULL;
+    }
+}
+
+DA_DEF da_arena da_arena_create(size_t chunk_bytes) {
+    da_arena arena = (da_arena)DA_MALLOC(sizeof(da_arena_t));
+    DA_ASSERT(arena != NULL);
+
+    arena->allocator.alloc_fn = da_arena_alloc_fn;
+    arena->allocator.realloc_fn = da_arena_realloc_fn;
+    arena->allocator.free_fn = da_arena_free_fn;
+    arena->allocator.context = arena;
+    arena->allocator.usable_size_fn = NULL;
+    arena->head = NULL;
+    arena->current = NULL;
+    arena->chunk_bytes = DA_ARENA_ROUND(chunk_bytes > 0 ? chunk_bytes : DA_ARENA_CHUNK_BYTES);
+    arena->last = NULL;
+    arena->last_size = 0;
+
+    return arena;
+}
+
+DA_DEF const da_allocator* da_arena_allocator(da_arena arena) {
+    DA_ASSERT(arena != NULL);
+    return &arena->allocator;
+}
+
+DA_DEF void da_arena_reset(da_arena arena) {
+    DA_ASSERT(arena != NULL);
+
+    for (da_arena_chunk* chunk = arena->head; chunk; chunk = chunk->next) {
+        chunk->used = 0;
+    }
+    arena->current = arena->head;
+    arena->last = NULL;
+    arena->last_size = 0;
+}
+
+DA_DEF void da_arena_destroy(da_arena* arena) {
+    DA_ASSERT(arena != NULL);
+    DA_ASSERT(*arena != NULL);
+
+    da_arena_chunk* chunk = (*arena)->head;
+    while (chunk) {
+        da_arena_chunk* next = chunk->next;
+        DA_FREE(chunk);
+        chunk = next;
+    }
+    DA_FREE(*arena);
+    *arena = NULL;
+}
+
+DA_DEF size_t da_arena_used(da_arena arena) {
+    DA_ASSERT(arena != NULL);
+
+    size_t used = 0;
+    for (da_arena_chunk* chunk = arena->head; chunk; chunk = chunk->next) {
+        used += chunk->used;
+    }
+    return used;
+}
+
+/* Additional Array Functions Implementation */
+
+DA_DEF void* da_peek(da_array arr) {
+    DA_ASSERT(arr != NULL);
+    DA_ASSERT(arr->length > 0);
+    return (char*)arr->data + ((arr->length - 1) * arr->element_size);
+}
+
+DA_DEF void* da_peek_first(da_array arr) {
+    DA_ASSERT(arr != NULL);
+    DA_ASSERT(arr->length > 0);
+    return arr->data;
+}
+
+DA_DEF void da_append_raw(da_array arr, const void* data, da_int_t count) {
+    DA_ASSERT(arr != NULL);
+    DA_ASSERT(data != NULL);
+    DA_ASSERT(count >= 0);
+
+    if (count == 0) return;  /* Nothing to append */
+
+    /* Ensure enough capacity */
+    da_int_t new_length = da_add_length(arr->length, count);
+    if (new_length > arr->capacity) {
+        da_grow(arr, new_length);
+    }
+
+    /* Copy all elements at once */
+    void* dest_ptr = (char*)arr->data + (arr->length * arr->element_size);
+    memcpy(dest_ptr, data, count * arr->element_size);
+    
+    /* Call retain function on all copied elements */
+    if (arr->retain_fn) {
+        for (da_int_t i = arr->length; i < new_length; i++) {
+            void* element_ptr = (char*)arr->data + (i * arr->element_size);
+            arr->retain_fn(element_ptr);
+        }
+    }
+    
+    arr->length = new_length;
+}
+
+DA_DEF void da_fill(da_array arr, const void* element, da_int_t count) {
+    DA_ASSERT(arr != NULL);
+    DA_ASSERT(element != NULL);
+    DA_ASSERT(count >= 0);
+
+    if (count == 0) return;  /* Nothing to fill */
+
+    /* Ensure enough capacity */
+    da_int_t new_length = da_add_length(arr->length, count);
+    if (new_length > arr->capacity) {
+        da_grow(arr, new_length);
+    }
+
+    /* Fill elements one by one */
+    for (da_int_t i = 0; i < count; i++) {
+        void* dest_ptr = (char*)arr->data + ((arr->length + i) * arr->element_size);
+        memcpy(dest_ptr, element, arr->element_size);
+    }
+    arr->length = new_length;
+}
+
+DA_DEF da_array da_slice(da_array arr, da_int_t start, da_int_t end) {
+    DA_ASSERT(arr != NULL);
+    DA_ASSERT(start >= 0 && start <= arr->length);
+    DA_ASSERT(end >= start && end <= arr->length);
+
+    da_int_t slice_length = end - start;
+#if DA_SHARED_EMPTY
+    if (slice_length == 0 && da_shared_empty_like(arr)) return da_shared_empty_like(arr);
+#endif
+
+    /* Create new array with exact capacity, inheriting retain/release functions */
+    da_array result = da_make_array(arr->element_size, slice_length, arr->retain_fn, arr->release_fn, arr->allocator,
+                                    arr->alignment);
+    result->length = slice_length;
+    result->growth = arr->growth;
+
+    if (slice_length > 0) {
+        /* Copy slice elements */
+        void* src_ptr = (char*)arr->data + (start * arr->element_size);
+        memcpy(result->data, src_ptr, slice_length * arr->element_size);
+        
+        /* Call retain function on all copied elements */
+        if (result->retain_fn) {
+            for (da_int_t i = 0; i < result->length; i++) {
+                void* element_ptr = (char*)result->data + (i * result->element_size);
+                result->retain_fn(element_ptr);
+            }
+        }
+    }
+
+    return result;
+}
+
+DA_DEF void da_remove_range(da_array arr, da_int_t start, da_int_t count) {
+    DA_ASSERT(arr != NULL);
+    DA_ASSERT(start >= 0 && start < arr->length);
+    DA_ASSERT(count >= 0);
+    DA_ASSERT(start + count <= arr->length);
+
+    if (count == 0) return;  /* Nothing to remove */
+    DA_CHECK_MUTABLE(arr);
+    DA_COW_UNSHARE(arr);
+
+    da_int_t end = start + count;
+
+    /* Call destructor on elements being removed */
+    if (arr->release_fn) {
+        for (da_int_t i = start; i < end; i++) {
+            void* element_ptr = (char*)arr->data + (i * arr->element_size);
+            arr->release_fn(element_ptr);
+        }
+    }
+
+    /* Shift elements after the range to the left */
+    if (end < arr->length) {
+        void* dest = (char*)arr->data + (start * arr->element_size);
+        void* src = (char*)arr->data + (end * arr->element_size);
+        size_t bytes_to_move = (size_t)(arr->length - end) * arr->element_size;
+        memmove(dest, src, bytes_to_move);
+    }
+
+    arr->length -= count;
+    da_auto_shrink(arr);
+}
+
+/* Swaps two non-overlapping elements through a stack buffer (no heap temp, any element size) */
+static void da_swap_bytes(char* a, char* b, da_int_t size) {
+    char temp[64];
+    while (size > 0) {
+        da_int_t chunk = size < (da_int_t)sizeof(temp) ? size : (da_int_t)sizeof(temp);
+        memcpy(temp, a, chunk);
+        memcpy(a, b, chunk);
+        memcpy(b, temp, chunk);
+        a += chunk;
+        b += chunk;
+        size -= chunk;
+    }
+}
+
+DA_DEF void da_reverse(da_array arr) {
+    DA_ASSERT(arr != NULL);
+
+    if (arr->length <= 1) return;  /* Nothing to reverse */
+    DA_CHECK_MUTABLE(arr);
+    DA_COW_UNSHARE(arr);
+
+    /* Swap elements from both ends moving toward center */
+    for (da_int_t i = 0; i < arr->length / 2; i++) {
+        da_int_t j = arr->length - 1 - i;
+
+        char* left = (char*)arr->data + (i * arr->element_size);
+        char* right = (char*)arr->data + (j * arr->element_size);
+
+        da_swap_bytes(left, right, arr->element_size);
+    }
+}
+
+DA_DEF void da_swap(da_array arr, da_int_t i, da_int_t j) {
+    DA_ASSERT(arr != NULL);
+    DA_ASSERT(i >= 0 && i < arr->length);
+    DA_ASSERT(j >= 0 && j < arr->length);
+
+    if (i == j) return;  /* No-op if same index */
+    DA_CHECK_MUTABLE(arr);
+    DA_COW_UNSHARE(arr);
+
+    char* elem_i = (char*)arr->data + (i * arr->element_size);
+    char* elem_j = (char*)arr->data + (j * arr->element_size);
+
+    da_swap_bytes(elem_i, elem_j, arr->element_size);
+}
+
+DA_DEF da_array da_copy(da_array arr) {
+    DA_ASSERT(arr != NULL);
+#if DA_SHARED_EMPTY
+    if (arr->length == 0 && da_shared_empty_like(arr)) return da_shared_empty_like(arr);
+#endif
+#if DA_COW
+    if (arr->length > 0 && !da_data_is_inline(arr)) {
+        if (!arr->shared) {
+            /* Turn the buffer into a shared one; the source's next growth unshares it too */
+            arr->shared = (da_shared_buffer*)da_mem_alloc(arr->allocator, sizeof(da_shared_buffer));
+            DA_ASSERT(arr->shared != NULL);
+            DA_ATOMIC_STORE(&arr->shared->ref_count, 1);
+            arr->shared->capacity = arr->capacity;
+            arr->capacity = arr->length;
+        }
+        (void)DA_ATOMIC_FETCH_ADD(&arr->shared->ref_count, 1);
+
+        da_array shared = da_make_array(arr->element_size, 0, arr->retain_fn, arr->release_fn, arr->allocator,
+                                        arr->alignment);
+        shared->growth = arr->growth;
+        shared->shared = arr->shared;
+        shared->data = arr->data;
+        shared->length = arr->length;
+        shared->capacity = arr->length;
+        return shared;
+    }
+#endif
+
+    /* Create new array with exact capacity = length, inheriting retain/release functions */
+    da_array result = da_make_array(arr->element_size, arr->length, arr->retain_fn, arr->release_fn, arr->allocator,
+                                    arr->alignment);
+    result->length = arr->length;
+    result->growth = arr->growth;
+
+    if (arr->length > 0) {
+        /* Copy all elements */
+        memcpy(result->data, arr->data, arr->length * arr->element_size);
+        
+        /* Call retain function on all copied elements */
+        if (result->retain_fn) {
+            for (da_int_t i = 0; i < result->length; i++) {
+                void* element_ptr = (char*)result->data + (i * result->element_size);
+                result->retain_fn(element_ptr);
+            }
+        }
+    }
+
+    return result;
+}
+
+/* The functional operations over length elements at data, producing arrays configured like arr */
+static da_array da_filter_range(da_array arr, const char* data, da_int_t length,
+                                int (*predicate)(const void* element, void* context), void* context) {
+    da_int_t start = 0;
+    const void* first_match = NULL;
+#if DA_SHARED_EMPTY
+    /* Nothing is allocated until the first match */
+    da_array empty = da_shared_empty_like(arr);
+    if (empty) {
+        while (start < length && !first_match) {
+            const void* element_ptr = data + (start++ * arr->element_size);
+            if (predicate(element_ptr, context)) first_match = element_ptr;
+        }
+        if (!first_match) return empty;
+    }
+#endif
+
+    /* Use builder for single-pass filtering */
+    da_builder builder = da_builder_create_with_allocator(arr->element_size, arr->allocator);
+    builder->growth = arr->growth;
+    builder->alignment = arr->alignment;
+
+    if (first_match) da_builder_append(builder, first_match);
+
+    /* Single pass: test and append matching elements */
+    for (da_int_t i = start; i < length; i++) {
+        const void* element_ptr = data + (i * arr->element_size);
+        if (predicate(element_ptr, context)) {
+            da_builder_append(builder, element_ptr);
+        }
+    }
+
+    /* Convert builder to array with exact capacity, inherit destructor */
+    da_array result = da_builder_to_array(&builder, arr->retain_fn, arr->release_fn);
+    return result;
+}
+
+static da_array da_map_range(da_array arr, const char* data, da_int_t length,
+                             void (*mapper)(const void* src, void* dst, void* context), void* context) {
+    /* Create new array with same length and exact capacity, inheriting retain/release functions */
+    da_array result = da_make_array(arr->element_size, length, arr->retain_fn, arr->release_fn, arr->allocator,
+                                    arr->alignment);
+    result->length = length;
+    result->growth = arr->growth;
+
+    /* Transform each element */
+    for (da_int_t i = 0; i < length; i++) {
+        const void* src_ptr = data + (i * arr->element_size);
+        void* dst_ptr = (char*)result->data + (i * arr->element_size);
+        mapper(src_ptr, dst_ptr, context);
+    }
+
+    return result;
+}
+
+static void da_reduce_range(da_int_t element_size, const char* data, da_int_t length, const void* initial,
+                            void* result, void (*reducer)(void* accumulator, const void* element, void* context),
+                            void* context) {
+    /* Initialize result with initial value */
+    memcpy(result, initial, element_size);
+
+    /* Apply reducer to each element */
+    for (da_int_t i = 0; i < length; i++) {
+        reducer(result, data + (i * element_size), context);
+    }
+}
+
+static da_int_t da_find_index_range(da_int_t element_size, const char* data, da_int_t length,
+                                    int (*predicate)(const void* element, void* context), void* context) {
+    for (da_int_t i = 0; i < length; i++) {
+        if (predicate(data + (i * element_size), context)) {
+            return i;
+        }
+    }
+
+    return -1;  // Not found
+}
+
+DA_DEF da_array da_filter(da_array arr, int (*predicate)(const void* element, void* context), void* context) {
+    DA_ASSERT(arr != NULL);
+    DA_ASSERT(predicate != NULL);
+    return da_filter_range(arr, (const char*)arr->data, arr->length, predicate, context);
+}
+
+DA_DEF da_array da_map(da_array arr, void (*mapper)(const void* src, void* dst, void* context), void* context) {
+    DA_ASSERT(arr != NULL);
+    DA_ASSERT(mapper != NULL);
+    return da_map_range(arr, (const char*)arr->data, arr->length, mapper, context);
+}
+
+DA_DEF void da_reduce(da_array arr, const void* initial, void* result,
+                      void (*reducer)(void* accumulator, const void* element, void* context), void* context) {
+    DA_ASSERT(arr != NULL);
+    DA_ASSERT(initial != NULL);
+    DA_ASSERT(result != NULL);
+    DA_ASSERT(reducer != NULL);
+    da_reduce_range(arr->element_size, (const char*)arr->data, arr->length, initial, result, reducer, context);
+}
+
+DA_DEF int da_is_empty(da_array arr) {
+    DA_ASSERT(arr != NULL);
+    return arr->length == 0;
+}
+
+DA_DEF da_int_t da_find_index(da_array arr, int (*predicate)(const void* element, void* context), void* context) {
+    DA_ASSERT(arr != NULL);
+    DA_ASSERT(predicate != NULL);
+    return da_find_index_range(arr->element_size, (const char*)arr->data, arr->length, predicate, context);
+}
+
+DA_DEF int da_contains(da_array arr, int (*predicate)(const void* element, void* context), void* context) {
+    return da_find_index(arr, predicate, context) != -1;
+}
+
+/* View Implementation */
 
-/**
- * @def DA_BUILDER_LEN(builder)
- * @brief Get builder length (shorthand for da_builder_length)
- */
+/* Asserts the parent still holds the viewed range and returns its first element */
+static const char* da_view_range(da_view_t view) {
+    DA_ASSERT(view.parent != NULL);
+    DA_ASSERT(view.offset + view.length <= view.parent->length);
+    return (const char*)view.parent->data + (view.offset * view.parent->element_size);
+}
 
-/**
- * @def DA_BUILDER_CAP(builder)
- * @brief Get builder capacity (shorthand for da_builder_capacity)
- */
+DA_DEF da_view_t da_view(da_array arr, da_int_t start, da_int_t end) {
+    DA_ASSERT(arr != NULL);
+    DA_ASSERT(start >= 0 && start <= arr->length);
+    DA_ASSERT(end >= start && end <= arr->length);
 
-/**
- * @def DA_BUILDER_CLEAR(builder)
- * @brief Clear builder (shorthand for da_builder_clear)
- */
+    da_view_t view = { da_retain(arr), start, end - start };
+    return view;
+}
 
-/**
- * @def DA_BUILDER_TO_ARRAY(builder)
- * @brief Convert builder to array (shorthand for da_builder_to_array)
- */
+DA_DEF da_view_t da_view_slice(da_view_t view, da_int_t start, da_int_t end) {
+    DA_ASSERT(view.parent != NULL);
+    DA_ASSERT(start >= 0 && start <= view.length);
+    DA_ASSERT(end >= start && end <= view.length);
 
-#define DA_BUILDER_CREATE(T) da_builder_create(sizeof(T))
+    da_view_t sub = { da_retain(view.parent), view.offset + start, end - start };
+    return sub;
+}
 
-#define DA_BUILDER_APPEND_TYPED(builder, val, T) do { T _temp = (val); da_builder_append(builder, (void*)&_temp); } while(0)
-#define DA_BUILDER_PUT_TYPED(builder, i, val, T) do { T _temp = (val); da_builder_set(builder, i, (void*)&_temp); } while(0)
+DA_DEF void da_view_release(da_view_t* view) {
+    DA_ASSERT(view != NULL);
+    da_release(&view->parent);
+    view->offset = 0;
+    view->length = 0;
+}
 
-#if DA_SUPPORT_TYPE_INFERENCE
-    #define DA_BUILDER_APPEND_INFERRED(builder, val) \
-        do { DA_MAKE_VAR_WITH_INFERRED_TYPE(_temp, val); da_builder_append(builder, (void*)&_temp); } while(0)
-    #define DA_BUILDER_PUT_INFERRED(builder, i, val) \
-        do { DA_MAKE_VAR_WITH_INFERRED_TYPE(_temp, val); da_builder_set(builder, i, (void*)&_temp); } while(0)
-#endif
+DA_DEF da_array da_materialize(da_view_t view) {
+    da_view_range(view);
+    return da_slice(view.parent, view.offset, view.offset + view.length);
+}
 
-#if DA_SUPPORT_TYPE_INFERENCE && !defined(DA_NOT_USE_TYPE_GENERIC)
-    #define DA_BUILDER_APPEND(builder, val) DA_BUILDER_APPEND_INFERRED(builder, val)
-    #define DA_BUILDER_PUT(builder, i, val) DA_BUILDER_PUT_INFERRED(builder, i, val)
-#else
-    #define DA_BUILDER_APPEND(builder, val, T) DA_BUILDER_APPEND_TYPED(builder, val, T)
-    #define DA_BUILDER_PUT(builder, i, val, T) DA_BUILDER_PUT_TYPED(builder, i, val, T)
-#endif
-/** @} */ // end of builder_macros group
+DA_DEF da_array da_view_filter(da_view_t view, int (*predicate)(const void* element, void* context), void* context) {
+    DA_ASSERT(predicate != NULL);
+    return da_filter_range(view.parent, da_view_range(view), view.length, predicate, context);
+}
 
+DA_DEF da_array da_view_map(da_view_t view, void (*mapper)(const void* src, void* dst, void* context), void* context) {
+    DA_ASSERT(mapper != NULL);
+    return da_map_range(view.parent, da_view_range(view), view.length, mapper, context);
+}
 
-#define DA_BUILDER_LEN(builder) da_builder_length(builder)
-#define DA_BUILDER_CAP(builder) da_builder_capacity(builder)
-#define DA_BUILDER_AT(builder, i, T) (*(T*)da_builder_get(builder, i))
-#define DA_BUILDER_CLEAR(builder) da_builder_clear(builder)
-#define DA_BUILDER_TO_ARRAY(builder) da_builder_to_array(builder, NULL, NULL)
-#define DA_BUILDER_TO_ARRAY_MANAGED(builder, retain_fn, release_fn) da_builder_to_array(builder, retain_fn, release_fn)
+DA_DEF void da_view_reduce(da_view_t view, const void* initial, void* result,
+                           void (*reducer)(void* accumulator, const void* element, void* context), void* context) {
+    DA_ASSERT(initial != NULL);
+    DA_ASSERT(result != NULL);
+    DA_ASSERT(reducer != NULL);
+    const char* data = da_view_range(view);
+    da_reduce_range(view.parent->element_size, data, view.length, initial, result, reducer, context);
+}
 
-/* Implementation */
-#ifdef DA_IMPLEMENTATION
+DA_DEF da_int_t da_view_find_index(da_view_t view, int (*predicate)(const void* element, void* context), void* context) {
+    DA_ASSERT(predicate != NULL);
+    const char* data = da_view_range(view);
+    return da_find_index_range(view.parent->element_size, data, view.length, predicate, context);
+}
 
-static int da_grow_capacity(int current_capacity, int min_needed) {
-    int new_capacity = current_capacity;
+// Helper structure for qsort context
+struct da_sort_context {
+    int (*compare)(const void* a, const void* b, void* context);
+    void* user_context;
+};
 
-#ifdef DA_GROWTH
-    /* Fixed growth strategy */
-    while (new_capacity < min_needed) {
-        new_capacity += DA_GROWTH;
-    }
-#else
-    /* Doubling strategy */
-    if (new_capacity == 0) new_capacity = 1;
-    while (new_capacity < min_needed) {
-        new_capacity *= 2;
-    }
-#endif
+// Global context for qsort (not thread-safe, but qsort isn't either)
+static struct da_sort_context* da_sort_global_context = NULL;
 
-    return new_capacity;
+// qsort comparison wrapper
+static int da_sort_compare_wrapper(const void* a, const void* b) {
+    struct da_sort_context* ctx = (struct da_sort_context*)da_sort_global_context;
+    return ctx->compare(a, b, ctx->user_context);
 }
 
-static int da_builder_grow_capacity(int current_capacity, int min_needed) {
-    /* Builders always use doubling strategy for fast construction */
-    int new_capacity = current_capacity;
-    if (new_capacity == 0) new_capacity = 1;
-    while (new_capacity < min_needed) {
-        new_capacity *= 2;
+DA_DEF void da_sort(da_array arr, int (*compare)(const void* a, const void* b, void* context), void* context) {
+    DA_ASSERT(arr != NULL);
+    DA_ASSERT(compare != NULL);
+    
+    if (arr->length <= 1) {
+        return;  // Already sorted or empty
     }
-    return new_capacity;
+    DA_CHECK_MUTABLE(arr);
+    DA_COW_UNSHARE(arr);
+    
+    // Set up global context for qsort wrapper
+    struct da_sort_context sort_ctx = { compare, context };
+    da_sort_global_context = &sort_ctx;
+    
+    // Use standard library qsort
+    qsort(arr->data, arr->length, arr->element_size, da_sort_compare_wrapper);
+    
+    // Clean up global context
+    da_sort_global_context = NULL;
 }
 
-/* Array Implementation */
+/* Deque Implementation */
 
-DA_DEF da_array da_new(int element_size) {
-    DA_ASSERT(element_size > 0);
+/* Ring slot of the element index places from the front */
+static da_int_t da_deque_slot(da_deque deque, da_int_t index) {
+    da_int_t slot = deque->head + index;
+    return slot >= deque->capacity ? slot - deque->capacity : slot;
+}
 
-    da_array arr = (da_array)DA_MALLOC(sizeof(da_array_t));
-    DA_ASSERT(arr != NULL);
+static void* da_deque_at_slot(da_deque deque, da_int_t slot) {
+    return (char*)deque->data + (slot * deque->element_size);
+}
 
-    DA_ATOMIC_STORE(&arr->ref_count, 1);
-    arr->length = 0;
-    arr->capacity = 0;  /* Deferred allocation */
-    arr->element_size = element_size;
-    arr->retain_fn = NULL;
-    arr->release_fn = NULL;
-    arr->data = NULL;
+/* Reallocates the ring to new_capacity, keeping the elements in order */
+static void da_deque_storage_resize(da_deque deque, da_int_t new_capacity) {
+    da_int_t old_capacity = deque->capacity;
+    da_int_t esz = deque->element_size;
+    deque->data = da_data_realloc(deque->allocator, 0, deque->data, (size_t)old_capacity * esz,
+                                  da_bytes(new_capacity, esz));
+    DA_ASSERT(deque->data != NULL);
+    deque->capacity = new_capacity;
+
+    if (deque->head + deque->length > old_capacity) {
+        /* Wrapped: [wrapped | ... | front] -- move whichever part is smaller */
+        da_int_t front = old_capacity - deque->head;
+        da_int_t wrapped = deque->length - front;
+        if (wrapped <= new_capacity - old_capacity && wrapped < front) {
+            memcpy(da_deque_at_slot(deque, old_capacity), deque->data, (size_t)wrapped * esz);
+        } else {
+            da_int_t new_head = new_capacity - front;
+            memmove(da_deque_at_slot(deque, new_head), da_deque_at_slot(deque, deque->head), (size_t)front * esz);
+            deque->head = new_head;
+        }
+    }
+}
 
-    return arr;
+static void da_deque_grow(da_deque deque, da_int_t min_capacity) {
+    da_deque_storage_resize(deque, da_policy_capacity(NULL, DA_GROW_DOUBLE, 0, deque->capacity, min_capacity,
+                                                      deque->element_size));
 }
 
-DA_DEF da_array da_create(int element_size, int initial_capacity, void (*retain_fn)(void*), void (*release_fn)(void*)) {
+DA_DEF da_deque da_deque_create(da_int_t element_size, da_int_t initial_capacity, void (*retain_fn)(void*),
+                                void (*release_fn)(void*)) {
+    return da_deque_create_with_allocator(element_size, initial_capacity, retain_fn, release_fn, NULL);
+}
+
+DA_DEF da_deque da_deque_create_with_allocator(da_int_t element_size, da_int_t initial_capacity,
+                                               void (*retain_fn)(void*), void (*release_fn)(void*),
+                                               const da_allocator* allocator) {
     DA_ASSERT(element_size > 0);
     DA_ASSERT(initial_capacity >= 0);
+    DA_ASSERT(allocator == NULL || (allocator->alloc_fn != NULL && allocator->free_fn != NULL));
+
+    da_deque deque = (da_deque)da_mem_alloc(allocator, sizeof(da_deque_t));
+    DA_ASSERT(deque != NULL);
+    deque->head = 0;
+    deque->length = 0;
+    deque->capacity = 0;
+    deque->element_size = element_size;
+    deque->data = NULL;
+    deque->retain_fn = retain_fn;
+    deque->release_fn = release_fn;
+    deque->allocator = allocator;
+    if (initial_capacity > 0) {
+        da_deque_storage_resize(deque, initial_capacity);
+    }
+    return deque;
+}
 
-    da_array arr = (da_array)DA_MALLOC(sizeof(da_array_t));
-    DA_ASSERT(arr != NULL);
+DA_DEF void da_deque_destroy(da_deque* deque) {
+    DA_ASSERT(deque != NULL);
+    DA_ASSERT(*deque != NULL);
 
-    DA_ATOMIC_STORE(&arr->ref_count, 1);
-    arr->length = 0;
-    arr->capacity = initial_capacity;
-    arr->element_size = element_size;
-    arr->retain_fn = retain_fn;
-    arr->release_fn = release_fn;
+    da_deque_clear(*deque);
+    if ((*deque)->data) {
+        da_data_free((*deque)->allocator, 0, (*deque)->data, (size_t)(*deque)->capacity * (*deque)->element_size);
+    }
+    da_mem_free((*deque)->allocator, *deque, sizeof(da_deque_t));
+    *deque = NULL;
+}
 
-    if (initial_capacity > 0) {
-        arr->data = DA_MALLOC(initial_capacity * element_size);
-        DA_ASSERT(arr->data != NULL);
-    } else {
-        arr->data = NULL;
+DA_DEF void da_deque_push(da_deque deque, const void* element) {
+    DA_ASSERT(deque != NULL);
+    DA_ASSERT(element != NULL);
+
+    if (deque->length == deque->capacity) {
+        da_deque_grow(deque, da_add_length(deque->length, 1));
     }
+    void* dest = da_deque_at_slot(deque, da_deque_slot(deque, deque->length));
+    memcpy(dest, element, deque->element_size);
+    if (deque->retain_fn) {
+        deque->retain_fn(dest);
+    }
+    deque->length++;
+}
 
-    return arr;
+DA_DEF void da_deque_pop(da_deque deque, void* out) {
+    DA_ASSERT(deque != NULL);
+    DA_ASSERT(deque->length > 0);
+
+    deque->length--;
+    void* src = da_deque_at_slot(deque, da_deque_slot(deque, deque->length));
+    if (out != NULL) {
+        memcpy(out, src, deque->element_size);
+    }
+    if (deque->release_fn) {
+        deque->release_fn(src);
+    }
+    if (deque->length == 0) deque->head = 0;
 }
 
-DA_DEF void da_release(da_array* arr) {
-    DA_ASSERT(arr != NULL);
-    DA_ASSERT(*arr != NULL);
+DA_DEF void da_deque_unshift(da_deque deque, const void* element) {
+    DA_ASSERT(deque != NULL);
+    DA_ASSERT(element != NULL);
 
-    int old_count = DA_ATOMIC_FETCH_SUB(&(*arr)->ref_count, 1);
+    if (deque->length == deque->capacity) {
+        da_deque_grow(deque, da_add_length(deque->length, 1));
+    }
+    deque->head = deque->head == 0 ? deque->capacity - 1 : deque->head - 1;
+    void* dest = da_deque_at_slot(deque, deque->head);
+    memcpy(dest, element, deque->element_size);
+    if (deque->retain_fn) {
+        deque->retain_fn(dest);
+    }
+    deque->length++;
+}
 
-    if (old_count == 1) {  /* We were the last reference */
-        if ((*arr)->data && (*arr)->release_fn) {
-            /* Call release function on each element before freeing */
-            for (int i = 0; i < (*arr)->length; i++) {
-                void* element_ptr = (char*)(*arr)->data + (i * (*arr)->element_size);
-                (*arr)->release_fn(element_ptr);
-            }
-        }
-        if ((*arr)->data) {
-            DA_FREE((*arr)->data);
-        }
-        DA_FREE(*arr);
+DA_DEF void da_deque_shift(da_deque deque, void* out) {
+    DA_ASSERT(deque != NULL);
+    DA_ASSERT(deque->length > 0);
+
+    void* src = da_deque_at_slot(deque, deque->head);
+    if (out != NULL) {
+        memcpy(out, src, deque->element_size);
+    }
+    if (deque->release_fn) {
+        deque->release_fn(src);
     }
+    deque->length--;
+    deque->head = deque->length == 0 || deque->head + 1 == deque->capacity ? 0 : deque->head + 1;
+}
 
-    *arr = NULL;  /* Always NULL the pointer for safety */
+DA_DEF void* da_deque_get(da_deque deque, da_int_t index) {
+    DA_ASSERT(deque != NULL);
+    DA_ASSERT(index >= 0 && index < deque->length);
+    return da_deque_at_slot(deque, da_deque_slot(deque, index));
 }
 
-DA_DEF da_array da_retain(da_array arr) {
-    DA_ASSERT(arr != NULL);
-    DA_ATOMIC_FETCH_ADD(&arr->ref_count, 1);
-    return arr;
+DA_DEF void* da_deque_peek_first(da_deque deque) {
+    DA_ASSERT(deque != NULL);
+    DA_ASSERT(deque->length > 0);
+    return da_deque_at_slot(deque, deque->head);
 }
 
-DA_DEF void* da_get(da_array arr, int index) {
-    DA_ASSERT(arr != NULL);
-    DA_ASSERT(index >= 0 && index < arr->length);
-    return (char*)arr->data + (index * arr->element_size);
+DA_DEF void* da_deque_peek(da_deque deque) {
+    DA_ASSERT(deque != NULL);
+    DA_ASSERT(deque->length > 0);
+    return da_deque_at_slot(deque, da_deque_slot(deque, deque->length - 1));
 }
 
-DA_DEF void* da_data(da_array arr) {
-    DA_ASSERT(arr != NULL);
-    return arr->data;
+DA_DEF da_int_t da_deque_length(da_deque deque) {
+    DA_ASSERT(deque != NULL);
+    return deque->length;
 }
 
-DA_DEF void da_set(da_array arr, int index, const void* element) {
-    DA_ASSERT(arr != NULL);
-    DA_ASSERT(element != NULL);
-    DA_ASSERT(index >= 0 && index < arr->length);
+DA_DEF da_int_t da_deque_capacity(da_deque deque) {
+    DA_ASSERT(deque != NULL);
+    return deque->capacity;
+}
 
-    void* dest = (char*)arr->data + (index * arr->element_size);
-    
-    /* Call release function on the old element before overwriting */
-    if (arr->release_fn) {
-        arr->release_fn(dest);
-    }
-    
-    memcpy(dest, element, arr->element_size);
-    
-    /* Call retain function on the newly set element */
-    if (arr->retain_fn) {
-        arr->retain_fn(dest);
+DA_DEF void da_deque_reserve(da_deque deque, da_int_t new_capacity) {
+    DA_ASSERT(deque != NULL);
+    DA_ASSERT(new_capacity >= 0);
+    if (new_capacity > deque->capacity) {
+        da_deque_storage_resize(deque, new_capacity);
     }
 }
 
-DA_DEF void da_push(da_array arr, const void* element) {
-    DA_ASSERT(arr != NULL);
-    DA_ASSERT(element != NULL);
+DA_DEF void da_deque_clear(da_deque deque) {
+    DA_ASSERT(deque != NULL);
+    if (deque->release_fn) {
+        for (da_int_t i = 0; i < deque->length; i++) {
+            deque->release_fn(da_deque_get(deque, i));
+        }
+    }
+    deque->length = 0;
+    deque->head = 0;
+}
 
-    if (arr->length >= arr->capacity) {
-        int new_capacity = da_grow_capacity(arr->capacity, arr->length + 1);
-        arr->data = DA_REALLOC(arr->data, new_capacity * arr->element_size);
-        DA_ASSERT(arr->data != NULL);
-        arr->capacity = new_capacity;
+DA_DEF void* da_deque_linearize(da_deque deque) {
+    DA_ASSERT(deque != NULL);
+    if (deque->length == 0) return NULL;
+    if (deque->head + deque->length <= deque->capacity) {
+        return da_deque_at_slot(deque, deque->head);  /* already contiguous */
     }
 
-    void* dest = (char*)arr->data + (arr->length * arr->element_size);
-    memcpy(dest, element, arr->element_size);
-    
-    /* Call retain function on the newly added element */
-    if (arr->retain_fn) {
-        arr->retain_fn(dest);
+    da_int_t esz = deque->element_size;
+    da_int_t front = deque->capacity - deque->head;
+    da_int_t wrapped = deque->length - front;
+
+    if (wrapped <= deque->capacity - deque->length) {
+        /* [wrapped | free | front] -> [wrapped | front | wrapped' | ...]: slide the front part down
+         * to just after the wrapped part, then copy the wrapped part behind it */
+        memmove(da_deque_at_slot(deque, wrapped), da_deque_at_slot(deque, deque->head), (size_t)front * esz);
+        memcpy(da_deque_at_slot(deque, wrapped + front), deque->data, (size_t)wrapped * esz);
+        deque->head = wrapped;
+    } else {
+        void* fresh = da_data_alloc(deque->allocator, 0, da_bytes(deque->capacity, esz));
+        DA_ASSERT(fresh != NULL);
+        memcpy(fresh, da_deque_at_slot(deque, deque->head), (size_t)front * esz);
+        memcpy((char*)fresh + (size_t)front * esz, deque->data, (size_t)wrapped * esz);
+        da_data_free(deque->allocator, 0, deque->data, (size_t)deque->capacity * esz);
+        deque->data = fresh;
+        deque->head = 0;
     }
-    
-    arr->length++;
+    return da_deque_at_slot(deque, deque->head);
 }
 
-DA_DEF void da_insert(da_array arr, int index, const void* element) {
-    DA_ASSERT(arr != NULL);
+/* Segmented Array Implementation */
+
+/* Chunk k holds first << k elements and starts at index first * (2^k - 1) */
+static da_int_t da_segmented_chunk_capacity(da_segmented seg, int chunk) {
+    return (da_int_t)1 << (seg->first_chunk_shift + chunk);
+}
+
+static da_int_t da_segmented_chunk_start(da_segmented seg, int chunk) {
+    return da_segmented_chunk_capacity(seg, chunk) - ((da_int_t)1 << seg->first_chunk_shift);
+}
+
+static void* da_segmented_slot(da_segmented seg, da_int_t index) {
+    unsigned long long biased = (unsigned long long)index + ((unsigned long long)1 << seg->first_chunk_shift);
+    int chunk = da_bit_width(biased) - 1 - seg->first_chunk_shift;
+    da_int_t offset = (da_int_t)(biased - ((unsigned long long)1 << (seg->first_chunk_shift + chunk)));
+    return (char*)seg->chunks[chunk] + (offset * seg->element_size);
+}
+
+static void da_segmented_add_chunk(da_segmented seg) {
+    int chunk = seg->chunk_count;
+    DA_ASSERT(seg->first_chunk_shift + chunk < DA_SEGMENTED_MAX_CHUNKS - 2);  /* capacity must fit da_int_t */
+    seg->chunks[chunk] = da_data_alloc(seg->allocator, 0, da_bytes(da_segmented_chunk_capacity(seg, chunk),
+                                                                   seg->element_size));
+    DA_ASSERT(seg->chunks[chunk] != NULL);
+    seg->chunk_count++;
+}
+
+DA_DEF da_segmented da_segmented_create(da_int_t element_size, da_int_t first_chunk, void (*retain_fn)(void*),
+                                        void (*release_fn)(void*)) {
+    return da_segmented_create_with_allocator(element_size, first_chunk, retain_fn, release_fn, NULL);
+}
+
+DA_DEF da_segmented da_segmented_create_with_allocator(da_int_t element_size, da_int_t first_chunk,
+                                                       void (*retain_fn)(void*), void (*release_fn)(void*),
+                                                       const da_allocator* allocator) {
+    DA_ASSERT(element_size > 0);
+    DA_ASSERT(first_chunk >= 0);
+    DA_ASSERT(allocator == NULL || (allocator->alloc_fn != NULL && allocator->free_fn != NULL));
+
+    da_segmented seg = (da_segmented)da_mem_alloc(allocator, sizeof(da_segmented_t));
+    DA_ASSERT(seg != NULL);
+    seg->length = 0;
+    seg->element_size = element_size;
+    if (first_chunk == 0) first_chunk = 16;
+    seg->first_chunk_shift = da_bit_width((unsigned long long)(first_chunk - 1));
+    DA_ASSERT(seg->first_chunk_shift < DA_SEGMENTED_MAX_CHUNKS - 2);
+    seg->chunk_count = 0;
+    seg->retain_fn = retain_fn;
+    seg->release_fn = release_fn;
+    seg->allocator = allocator;
+    return seg;
+}
+
+DA_DEF void da_segmented_destroy(da_segmented* seg) {
+    DA_ASSERT(seg != NULL);
+    DA_ASSERT(*seg != NULL);
+
+    da_segmented_clear(*seg);
+    da_segmented_trim(*seg);
+    da_mem_free((*seg)->allocator, *seg, sizeof(da_segmented_t));
+    *seg = NULL;
+}
+
+DA_DEF void* da_segmented_push(da_segmented seg, const void* element) {
+    DA_ASSERT(seg != NULL);
     DA_ASSERT(element != NULL);
-    DA_ASSERT(index >= 0 && index <= arr->length);
 
-    /* Grow array if needed */
-    if (arr->length >= arr->capacity) {
-        int new_capacity = da_grow_capacity(arr->capacity, arr->length + 1);
-        arr->data = DA_REALLOC(arr->data, new_capacity * arr->element_size);
-        DA_ASSERT(arr->data != NULL);
-        arr->capacity = new_capacity;
+    if (seg->length == da_segmented_capacity(seg)) {
+        da_segmented_add_chunk(seg);
     }
+    void* dest = da_segmented_slot(seg, seg->length);
+    memcpy(dest, element, seg->element_size);
+    if (seg->retain_fn) {
+        seg->retain_fn(dest);
+    }
+    seg->length++;
+    return dest;
+}
 
-    /* Shift elements to the right if not inserting at the end */
-    if (index < arr->length) {
-        void* src = (char*)arr->data + (index * arr->element_size);
-        void* dest = (char*)arr->data + ((index + 1) * arr->element_size);
-        int bytes_to_move = (arr->length - index) * arr->element_size;
-        memmove(dest, src, bytes_to_move);
+DA_DEF void da_segmented_pop(da_segmented seg, void* out) {
+    DA_ASSERT(seg != NULL);
+    DA_ASSERT(seg->length > 0);
+
+    seg->length--;
+    void* src = da_segmented_slot(seg, seg->length);
+    if (out != NULL) {
+        memcpy(out, src, seg->element_size);
+    }
+    if (seg->release_fn) {
+        seg->release_fn(src);
     }
+}
 
-    /* Insert the new element */
-    void* insert_pos = (char*)arr->data + (index * arr->element_size);
-    memcpy(insert_pos, element, arr->element_size);
-    
-    /* Call retain function on the newly inserted element */
-    if (arr->retain_fn) {
-        arr->retain_fn(insert_pos);
+DA_DEF void* da_segmented_get(da_segmented seg, da_int_t index) {
+    DA_ASSERT(seg != NULL);
+    DA_ASSERT(index >= 0 && index < seg->length);
+    return da_segmented_slot(seg, index);
+}
+
+DA_DEF void* da_segmented_peek(da_segmented seg) {
+    DA_ASSERT(seg != NULL);
+    DA_ASSERT(seg->length > 0);
+    return da_segmented_slot(seg, seg->length - 1);
+}
+
+DA_DEF da_int_t da_segmented_length(da_segmented seg) {
+    DA_ASSERT(seg != NULL);
+    return seg->length;
+}
+
+DA_DEF da_int_t da_segmented_capacity(da_segmented seg) {
+    DA_ASSERT(seg != NULL);
+    return da_segmented_chunk_start(seg, seg->chunk_count);
+}
+
+DA_DEF void da_segmented_reserve(da_segmented seg, da_int_t new_capacity) {
+    DA_ASSERT(seg != NULL);
+    DA_ASSERT(new_capacity >= 0);
+    while (da_segmented_capacity(seg) < new_capacity) {
+        da_segmented_add_chunk(seg);
     }
-    
-    arr->length++;
 }
 
-DA_DEF void da_remove(da_array arr, int index, void* out) {
-    DA_ASSERT(arr != NULL);
-    DA_ASSERT(index >= 0 && index < arr->length);
+DA_DEF void da_segmented_trim(da_segmented seg) {
+    DA_ASSERT(seg != NULL);
+    while (seg->chunk_count > 0 && da_segmented_chunk_start(seg, seg->chunk_count - 1) >= seg->length) {
+        int chunk = --seg->chunk_count;
+        da_data_free(seg->allocator, 0, seg->chunks[chunk],
+                     (size_t)da_segmented_chunk_capacity(seg, chunk) * seg->element_size);
+        seg->chunks[chunk] = NULL;
+    }
+}
 
-    void* element_ptr = (char*)arr->data + (index * arr->element_size);
-    
-    /* Copy element to output if requested */
-    if (out != NULL) {
-        memcpy(out, element_ptr, arr->element_size);
+DA_DEF void da_segmented_clear(da_segmented seg) {
+    DA_ASSERT(seg != NULL);
+    if (seg->release_fn) {
+        for (da_int_t i = 0; i < seg->length; i++) {
+            seg->release_fn(da_segmented_slot(seg, i));
+        }
     }
-    
-    /* Call destructor on the removed element */
-    if (arr->release_fn) {
-        arr->release_fn(element_ptr);
+    seg->length = 0;
+}
+
+DA_DEF void da_segmented_export(da_segmented seg, void* dest) {
+    DA_ASSERT(seg != NULL);
+    DA_ASSERT(dest != NULL || seg->length == 0);
+
+    char* out = (char*)dest;
+    for (int chunk = 0; chunk < seg->chunk_count; chunk++) {
+        da_int_t start = da_segmented_chunk_start(seg, chunk);
+        if (start >= seg->length) break;
+        da_int_t count = da_segmented_chunk_capacity(seg, chunk);
+        if (count > seg->length - start) count = seg->length - start;
+        memcpy(out, seg->chunks[chunk], (size_t)count * seg->element_size);
+        out += (size_t)count * seg->element_size;
     }
+}
 
-    /* Shift elements to the left if not removing the last element */
-    if (index < arr->length - 1) {
-        void* dest = (char*)arr->data + (index * arr->element_size);
-        void* src = (char*)arr->data + ((index + 1) * arr->element_size);
-        int bytes_to_move = (arr->length - index - 1) * arr->element_size;
-        memmove(dest, src, bytes_to_move);
+DA_DEF da_array da_segmented_to_array(da_segmented seg) {
+    DA_ASSERT(seg != NULL);
+
+    da_array arr = da_create_with_allocator(seg->element_size, seg->length, seg->retain_fn, seg->release_fn,
+                                            seg->allocator);
+    for (int chunk = 0; chunk < seg->chunk_count; chunk++) {
+        da_int_t start = da_segmented_chunk_start(seg, chunk);
+        if (start >= seg->length) break;
+        da_int_t count = da_segmented_chunk_capacity(seg, chunk);
+        if (count > seg->length - start) count = seg->length - start;
+        da_append_raw(arr, seg->chunks[chunk], count);
     }
+    return arr;
+}
 
-    arr->length--;
+/* Gap Buffer Implementation */
+
+static da_int_t da_gap_size(da_gap gap) {
+    return gap->gap_end - gap->gap_start;
 }
 
-DA_DEF void da_pop(da_array arr, void* out) {
-    DA_ASSERT(arr != NULL);
-    DA_ASSERT(arr->length > 0);
+static void* da_gap_at_slot(da_gap gap, da_int_t slot) {
+    return (char*)gap->data + (slot * gap->element_size);
+}
 
-    arr->length--;
+static void* da_gap_slot(da_gap gap, da_int_t index) {
+    return da_gap_at_slot(gap, index < gap->gap_start ? index : index + da_gap_size(gap));
+}
 
-    void* src = (char*)arr->data + (arr->length * arr->element_size);
-    if (out != NULL) {
-        memcpy(out, src, arr->element_size);
-    }
-    
-    /* Call release function on the popped element */
-    if (arr->release_fn) {
-        arr->release_fn(src);
+/* Slides the gap so that it starts at index, moving only the elements in between */
+static void da_gap_move_to(da_gap gap, da_int_t index) {
+    da_int_t esz = gap->element_size;
+    if (index < gap->gap_start) {
+        da_int_t count = gap->gap_start - index;
+        memmove(da_gap_at_slot(gap, gap->gap_end - count), da_gap_at_slot(gap, index), (size_t)count * esz);
+        gap->gap_start -= count;
+        gap->gap_end -= count;
+    } else if (index > gap->gap_start) {
+        da_int_t count = index - gap->gap_start;
+        memmove(da_gap_at_slot(gap, gap->gap_start), da_gap_at_slot(gap, gap->gap_end), (size_t)count * esz);
+        gap->gap_start += count;
+        gap->gap_end += count;
     }
 }
 
-DA_DEF void da_clear(da_array arr) {
-    DA_ASSERT(arr != NULL);
-    
-    /* Call release function on all elements before clearing */
-    if (arr->release_fn && arr->data) {
-        for (int i = 0; i < arr->length; i++) {
-            void* element_ptr = (char*)arr->data + (i * arr->element_size);
-            arr->release_fn(element_ptr);
-        }
+/* Reallocates to new_capacity and moves the elements after the gap to the new end */
+static void da_gap_storage_resize(da_gap gap, da_int_t new_capacity) {
+    da_int_t old_capacity = gap->capacity;
+    da_int_t tail = old_capacity - gap->gap_end;
+    gap->data = da_data_realloc(gap->allocator, 0, gap->data, (size_t)old_capacity * gap->element_size,
+                                da_bytes(new_capacity, gap->element_size));
+    DA_ASSERT(gap->data != NULL);
+    gap->capacity = new_capacity;
+    gap->gap_end = new_capacity - tail;
+    memmove(da_gap_at_slot(gap, gap->gap_end), da_gap_at_slot(gap, old_capacity - tail),
+            (size_t)tail * gap->element_size);
+}
+
+static void da_gap_make_room(da_gap gap, da_int_t count) {
+    if (da_gap_size(gap) < count) {
+        da_int_t needed = da_add_length(da_gap_length(gap), count);
+        da_gap_storage_resize(gap, da_policy_capacity(NULL, DA_GROW_DOUBLE, 0, gap->capacity, needed,
+                                                      gap->element_size));
     }
-    
-    arr->length = 0;
 }
 
-DA_DEF int da_length(da_array arr) {
-    DA_ASSERT(arr != NULL);
-    return arr->length;
+DA_DEF da_gap da_gap_create(da_int_t element_size, da_int_t initial_capacity, void (*retain_fn)(void*),
+                            void (*release_fn)(void*)) {
+    return da_gap_create_with_allocator(element_size, initial_capacity, retain_fn, release_fn, NULL);
 }
 
-DA_DEF int da_capacity(da_array arr) {
-    DA_ASSERT(arr != NULL);
-    return arr->capacity;
+DA_DEF da_gap da_gap_create_with_allocator(da_int_t element_size, da_int_t initial_capacity,
+                                           void (*retain_fn)(void*), void (*release_fn)(void*),
+                                           const da_allocator* allocator) {
+    DA_ASSERT(element_size > 0);
+    DA_ASSERT(initial_capacity >= 0);
+    DA_ASSERT(allocator == NULL || (allocator->alloc_fn != NULL && allocator->free_fn != NULL));
+
+    da_gap gap = (da_gap)da_mem_alloc(allocator, sizeof(da_gap_t));
+    DA_ASSERT(gap != NULL);
+    gap->gap_start = 0;
+    gap->gap_end = 0;
+    gap->capacity = 0;
+    gap->element_size = element_size;
+    gap->data = NULL;
+    gap->retain_fn = retain_fn;
+    gap->release_fn = release_fn;
+    gap->allocator = allocator;
+    if (initial_capacity > 0) {
+        da_gap_storage_resize(gap, initial_capacity);
+    }
+    return gap;
 }
 
-DA_DEF void da_reserve(da_array arr, int new_capacity) {
-    DA_ASSERT(arr != NULL);
-    DA_ASSERT(new_capacity >= 0);
+DA_DEF void da_gap_destroy(da_gap* gap) {
+    DA_ASSERT(gap != NULL);
+    DA_ASSERT(*gap != NULL);
 
-    if (new_capacity > arr->capacity) {
-        arr->data = DA_REALLOC(arr->data, new_capacity * arr->element_size);
-        DA_ASSERT(arr->data != NULL);
-        arr->capacity = new_capacity;
+    da_gap_clear(*gap);
+    if ((*gap)->data) {
+        da_data_free((*gap)->allocator, 0, (*gap)->data, (size_t)(*gap)->capacity * (*gap)->element_size);
     }
+    da_mem_free((*gap)->allocator, *gap, sizeof(da_gap_t));
+    *gap = NULL;
 }
 
-DA_DEF void da_resize(da_array arr, int new_length) {
-    DA_ASSERT(arr != NULL);
-    DA_ASSERT(new_length >= 0);
+DA_DEF void da_gap_insert(da_gap gap, da_int_t index, const void* element) {
+    da_gap_insert_raw(gap, index, element, 1);
+}
 
-    if (new_length > arr->capacity) {
-        da_reserve(arr, new_length);
+DA_DEF void da_gap_insert_raw(da_gap gap, da_int_t index, const void* data, da_int_t count) {
+    DA_ASSERT(gap != NULL);
+    DA_ASSERT(data != NULL);
+    DA_ASSERT(count >= 0);
+    DA_ASSERT(index >= 0 && index <= da_gap_length(gap));
+
+    if (count == 0) return;
+    da_gap_make_room(gap, count);
+    da_gap_move_to(gap, index);
+    void* dest = da_gap_at_slot(gap, gap->gap_start);
+    memcpy(dest, data, (size_t)count * gap->element_size);
+    if (gap->retain_fn) {
+        for (da_int_t i = 0; i < count; i++) {
+            gap->retain_fn(da_gap_at_slot(gap, gap->gap_start + i));
+        }
     }
+    gap->gap_start += count;
+}
 
-    if (new_length < arr->length) {
-        /* Call destructor on elements being removed */
-        if (arr->release_fn && arr->data) {
-            for (int i = new_length; i < arr->length; i++) {
-                void* element_ptr = (char*)arr->data + (i * arr->element_size);
-                arr->release_fn(element_ptr);
-            }
+DA_DEF void da_gap_remove(da_gap gap, da_int_t index, void* out) {
+    DA_ASSERT(gap != NULL);
+    DA_ASSERT(index >= 0 && index < da_gap_length(gap));
+
+    if (out != NULL) {
+        memcpy(out, da_gap_slot(gap, index), gap->element_size);
+    }
+    da_gap_remove_range(gap, index, 1);
+}
+
+DA_DEF void da_gap_remove_range(da_gap gap, da_int_t start, da_int_t count) {
+    DA_ASSERT(gap != NULL);
+    DA_ASSERT(start >= 0 && count >= 0);
+    DA_ASSERT(start <= da_gap_length(gap) - count);
+
+    if (count == 0) return;
+    if (gap->release_fn) {
+        for (da_int_t i = start; i < start + count; i++) {
+            gap->release_fn(da_gap_slot(gap, i));
         }
-    } else if (new_length > arr->length) {
-        /* Zero-fill new elements */
-        void* start = (char*)arr->data + (arr->length * arr->element_size);
-        int bytes_to_zero = (new_length - arr->length) * arr->element_size;
-        memset(start, 0, bytes_to_zero);
     }
+    /* Whichever end of the range is nearer the gap decides the direction: the removed
+     * elements are then absorbed into the gap without being moved */
+    if (start + count <= gap->gap_start) {
+        da_gap_move_to(gap, start + count);
+        gap->gap_start -= count;
+    } else {
+        da_gap_move_to(gap, start);
+        gap->gap_end += count;
+    }
+}
 
-    arr->length = new_length;
+DA_DEF void da_gap_push(da_gap gap, const void* element) {
+    DA_ASSERT(gap != NULL);
+    da_gap_insert_raw(gap, da_gap_length(gap), element, 1);
 }
 
-DA_DEF void da_trim(da_array arr, int new_capacity) {
-    DA_ASSERT(arr != NULL);
-    DA_ASSERT(new_capacity >= arr->length);
+DA_DEF void* da_gap_get(da_gap gap, da_int_t index) {
+    DA_ASSERT(gap != NULL);
+    DA_ASSERT(index >= 0 && index < da_gap_length(gap));
+    return da_gap_slot(gap, index);
+}
 
-    if (new_capacity < arr->capacity) {
-        if (new_capacity == 0) {
-            if (arr->data) {
-                DA_FREE(arr->data);
-                arr->data = NULL;
-            }
-        } else {
-            arr->data = DA_REALLOC(arr->data, new_capacity * arr->element_size);
-            DA_ASSERT(arr->data != NULL);
-        }
-        arr->capacity = new_capacity;
+DA_DEF void da_gap_set(da_gap gap, da_int_t index, const void* element) {
+    DA_ASSERT(gap != NULL);
+    DA_ASSERT(element != NULL);
+    DA_ASSERT(index >= 0 && index < da_gap_length(gap));
+
+    void* dest = da_gap_slot(gap, index);
+    if (gap->release_fn) {
+        gap->release_fn(dest);
+    }
+    memcpy(dest, element, gap->element_size);
+    if (gap->retain_fn) {
+        gap->retain_fn(dest);
     }
 }
 
-DA_DEF void da_append_array(da_array dest, da_array src) {
-    DA_ASSERT(dest != NULL);
-    DA_ASSERT(src != NULL);
-    DA_ASSERT(dest->element_size == src->element_size);
+DA_DEF da_int_t da_gap_length(da_gap gap) {
+    DA_ASSERT(gap != NULL);
+    return gap->capacity - da_gap_size(gap);
+}
 
-    if (src->length == 0) return;  /* Nothing to append */
+DA_DEF da_int_t da_gap_capacity(da_gap gap) {
+    DA_ASSERT(gap != NULL);
+    return gap->capacity;
+}
 
-    /* Ensure dest has enough capacity */
-    int new_length = dest->length + src->length;
-    if (new_length > dest->capacity) {
-        int new_capacity = da_grow_capacity(dest->capacity, new_length);
-        dest->data = DA_REALLOC(dest->data, new_capacity * dest->element_size);
-        DA_ASSERT(dest->data != NULL);
-        dest->capacity = new_capacity;
+DA_DEF void da_gap_reserve(da_gap gap, da_int_t new_capacity) {
+    DA_ASSERT(gap != NULL);
+    DA_ASSERT(new_capacity >= 0);
+    if (new_capacity > gap->capacity) {
+        da_gap_storage_resize(gap, new_capacity);
     }
+}
 
-    /* Copy all elements from src to end of dest */
-    void* dest_ptr = (char*)dest->data + (dest->length * dest->element_size);
-    memcpy(dest_ptr, src->data, src->length * src->element_size);
-    
-    /* Call retain function on all copied elements */
-    if (dest->retain_fn) {
-        for (int i = dest->length; i < new_length; i++) {
-            void* element_ptr = (char*)dest->data + (i * dest->element_size);
-            dest->retain_fn(element_ptr);
+DA_DEF void da_gap_clear(da_gap gap) {
+    DA_ASSERT(gap != NULL);
+    if (gap->release_fn) {
+        da_int_t length = da_gap_length(gap);
+        for (da_int_t i = 0; i < length; i++) {
+            gap->release_fn(da_gap_slot(gap, i));
         }
     }
-    
-    dest->length = new_length;
+    gap->gap_start = 0;
+    gap->gap_end = gap->capacity;
 }
 
-DA_DEF da_array da_concat(da_array arr1, da_array arr2) {
-    DA_ASSERT(arr1 != NULL);
-    DA_ASSERT(arr2 != NULL);
-    DA_ASSERT(arr1->element_size == arr2->element_size);
+DA_DEF da_array da_gap_to_array(da_gap gap) {
+    DA_ASSERT(gap != NULL);
 
-    int total_length = arr1->length + arr2->length;
+    da_array arr = da_create_with_allocator(gap->element_size, da_gap_length(gap), gap->retain_fn,
+                                            gap->release_fn, gap->allocator);
+    if (gap->gap_start > 0) {
+        da_append_raw(arr, gap->data, gap->gap_start);
+    }
+    if (gap->gap_end < gap->capacity) {
+        da_append_raw(arr, da_gap_at_slot(gap, gap->gap_end), gap->capacity - gap->gap_end);
+    }
+    return arr;
+}
 
-    /* Create new array with exact capacity */
-    da_array result = (da_array)DA_MALLOC(sizeof(da_array_t));
-    DA_ASSERT(result != NULL);
+/* Big Array Implementation */
 
-    DA_ATOMIC_STORE(&result->ref_count, 1);
-    result->length = total_length;
-    result->capacity = total_length;  /* Exact capacity */
-    result->element_size = arr1->element_size;
-    result->retain_fn = arr1->retain_fn;   /* Inherit retain function from first array */
-    result->release_fn = arr1->release_fn;  /* Inherit release function from first array */
+#define DA_BIGARRAY_FANOUT 32
 
-    if (total_length > 0) {
-        result->data = DA_MALLOC(total_length * result->element_size);
-        DA_ASSERT(result->data != NULL);
+/* Every node starts with its item count: elements in a leaf, children in a branch */
+typedef struct da_bignode_s {
+    da_int_t count;
+} da_bignode;
 
-        /* Copy arr1 elements first */
-        if (arr1->length > 0) {
-            memcpy(result->data, arr1->data, arr1->length * result->element_size);
-        }
+typedef struct {
+    da_bignode node;
+    da_int_t sizes[DA_BIGARRAY_FANOUT];        /* elements under each child */
+    da_bignode* children[DA_BIGARRAY_FANOUT];
+} da_bigbranch;
 
-        /* Copy arr2 elements after arr1 */
-        if (arr2->length > 0) {
-            void* dest_ptr = (char*)result->data + (arr1->length * result->element_size);
-            memcpy(dest_ptr, arr2->data, arr2->length * result->element_size);
-        }
-        
-        /* Call retain function on all copied elements */
-        if (result->retain_fn) {
-            for (int i = 0; i < result->length; i++) {
-                void* element_ptr = (char*)result->data + (i * result->element_size);
-                result->retain_fn(element_ptr);
-            }
-        }
-    } else {
-        result->data = NULL;
-    }
+/* Leaf elements start after the count, aligned like arena allocations */
+#define DA_BIGARRAY_LEAF_HEADER ((sizeof(da_bignode) + 2 * sizeof(void*) - 1) & ~(2 * sizeof(void*) - 1))
 
-    return result;
+static void* da_big_leaf_at(da_bigarray big, da_bignode* leaf, da_int_t i) {
+    return (char*)leaf + DA_BIGARRAY_LEAF_HEADER + (i * big->element_size);
 }
 
-/* Builder Implementation */
+static size_t da_big_node_bytes(da_bigarray big, int level) {
+    return level == 0 ? DA_BIGARRAY_LEAF_HEADER + (size_t)big->leaf_capacity * big->element_size
+                      : sizeof(da_bigbranch);
+}
 
-DA_DEF da_builder da_builder_create(int element_size) {
-    DA_ASSERT(element_size > 0);
+static da_bignode* da_big_new_node(da_bigarray big, int level) {
+    da_bignode* node = (da_bignode*)da_mem_alloc(big->allocator, da_big_node_bytes(big, level));
+    DA_ASSERT(node != NULL);
+    node->count = 0;
+    return node;
+}
 
-    da_builder builder = (da_builder)DA_MALLOC(sizeof(da_builder_t));
-    DA_ASSERT(builder != NULL);
+static void da_big_free_node(da_bigarray big, da_bignode* node, int level) {
+    da_mem_free(big->allocator, node, da_big_node_bytes(big, level));
+}
 
-    builder->length = 0;
-    builder->capacity = 0;
-    builder->element_size = element_size;
-    builder->data = NULL;
+static void da_big_free_tree(da_bigarray big, da_bignode* node, int level) {
+    if (level > 0) {
+        da_bigbranch* branch = (da_bigbranch*)node;
+        for (da_int_t i = 0; i < node->count; i++) {
+            da_big_free_tree(big, branch->children[i], level - 1);
+        }
+    }
+    da_big_free_node(big, node, level);
+}
 
-    return builder;
+static da_int_t da_big_node_capacity(da_bigarray big, int level) {
+    return level == 0 ? big->leaf_capacity : DA_BIGARRAY_FANOUT;
 }
 
-DA_DEF void da_builder_append(da_builder builder, const void* element) {
-    DA_ASSERT(builder != NULL);
-    DA_ASSERT(element != NULL);
+static da_int_t da_big_node_size(da_bignode* node, int level) {
+    if (level == 0) return node->count;
+    da_bigbranch* branch = (da_bigbranch*)node;
+    da_int_t size = 0;
+    for (da_int_t i = 0; i < node->count; i++) {
+        size += branch->sizes[i];
+    }
+    return size;
+}
 
-    if (builder->length >= builder->capacity) {
-        int new_capacity = da_builder_grow_capacity(builder->capacity, builder->length + 1);
-        builder->data = DA_REALLOC(builder->data, new_capacity * builder->element_size);
-        DA_ASSERT(builder->data != NULL);
-        builder->capacity = new_capacity;
+/* Moves n items (elements, or children with their sizes) from src[from] to dst[to]; may overlap */
+static void da_big_move_items(da_bigarray big, int level, da_bignode* dst, da_int_t to, da_bignode* src,
+                              da_int_t from, da_int_t n) {
+    if (n <= 0) return;
+    if (level == 0) {
+        memmove(da_big_leaf_at(big, dst, to), da_big_leaf_at(big, src, from), (size_t)n * big->element_size);
+    } else {
+        da_bigbranch* d = (da_bigbranch*)dst;
+        da_bigbranch* s = (da_bigbranch*)src;
+        memmove(&d->children[to], &s->children[from], (size_t)n * sizeof(da_bignode*));
+        memmove(&d->sizes[to], &s->sizes[from], (size_t)n * sizeof(da_int_t));
     }
+}
 
-    void* dest = (char*)builder->data + (builder->length * builder->element_size);
-    memcpy(dest, element, builder->element_size);
-    builder->length++;
+/* Descends to the leaf holding index; *offset receives the position inside it */
+static da_bignode* da_big_find(da_bigarray big, da_int_t index, da_int_t* offset) {
+    da_bignode* node = big->root;
+    for (int level = big->height; level > 0; level--) {
+        da_bigbranch* branch = (da_bigbranch*)node;
+        da_int_t i = 0;
+        while (index >= branch->sizes[i]) {
+            index -= branch->sizes[i];
+            i++;
+        }
+        node = branch->children[i];
+    }
+    *offset = index;
+    return node;
 }
 
-DA_DEF void da_builder_reserve(da_builder builder, int new_capacity) {
-    DA_ASSERT(builder != NULL);
-    DA_ASSERT(new_capacity >= 0);
+/* Inserts into the subtree; returns the new right sibling when the node had to split.
+ * A node split by an append keeps all its items, so pushes leave full nodes behind. */
+static da_bignode* da_big_insert(da_bigarray big, da_bignode* node, int level, da_int_t index, const void* element) {
+    da_bigbranch* branch = (da_bigbranch*)node;
+    da_bignode* child_split = NULL;
+    da_int_t child_split_size = 0;
+
+    if (level == 0) {
+        if (node->count < big->leaf_capacity) {
+            da_big_move_items(big, 0, node, index + 1, node, index, node->count - index);
+            memcpy(da_big_leaf_at(big, node, index), element, big->element_size);
+            node->count++;
+            return NULL;
+        }
+    } else {
+        da_int_t i = 0;
+        while (i < node->count - 1 && index > branch->sizes[i]) {
+            index -= branch->sizes[i];
+            i++;
+        }
+        child_split = da_big_insert(big, branch->children[i], level - 1, index, element);
+        branch->sizes[i]++;
+        if (child_split == NULL) return NULL;
+
+        /* The child's new sibling goes in at i + 1 */
+        child_split_size = da_big_node_size(child_split, level - 1);
+        branch->sizes[i] -= child_split_size;
+        index = i + 1;
+        if (node->count < DA_BIGARRAY_FANOUT) {
+            da_big_move_items(big, level, node, index + 1, node, index, node->count - index);
+            branch->children[index] = child_split;
+            branch->sizes[index] = child_split_size;
+            node->count++;
+            return NULL;
+        }
+    }
 
-    if (new_capacity > builder->capacity) {
-        builder->data = DA_REALLOC(builder->data, new_capacity * builder->element_size);
-        DA_ASSERT(builder->data != NULL);
-        builder->capacity = new_capacity;
+    /* Full: move the upper half (nothing, when appending) into a new right sibling */
+    da_int_t capacity = da_big_node_capacity(big, level);
+    da_int_t half = index == capacity ? capacity : capacity / 2;
+    da_bignode* right = da_big_new_node(big, level);
+    da_big_move_items(big, level, right, 0, node, half, capacity - half);
+    right->count = capacity - half;
+    node->count = half;
+
+    da_bignode* target = node;
+    if (index > half || (index == half && half == capacity)) {
+        target = right;
+        index -= half;
+    }
+    if (level == 0) {
+        da_big_insert(big, target, 0, index, element);
+    } else {
+        da_bigbranch* t = (da_bigbranch*)target;
+        da_big_move_items(big, level, target, index + 1, target, index, target->count - index);
+        t->children[index] = child_split;
+        t->sizes[index] = child_split_size;
+        target->count++;
     }
+    return right;
 }
 
-DA_DEF void da_builder_append_array(da_builder builder, da_array arr) {
-    DA_ASSERT(builder != NULL);
-    DA_ASSERT(arr != NULL);
-    DA_ASSERT(builder->element_size == arr->element_size);
+/* Merges or rebalances child i of a branch at level when it fell below half full */
+static void da_big_fix_child(da_bigarray big, da_bigbranch* branch, int level, da_int_t i) {
+    int child_level = level - 1;
+    da_int_t capacity = da_big_node_capacity(big, child_level);
+    if (branch->children[i]->count >= capacity / 2 || branch->node.count < 2) return;
+
+    da_int_t left = i > 0 ? i - 1 : i;
+    da_bignode* a = branch->children[left];
+    da_bignode* b = branch->children[left + 1];
+    if (a->count + b->count <= capacity) {
+        da_big_move_items(big, child_level, a, a->count, b, 0, b->count);
+        a->count += b->count;
+        branch->sizes[left] += branch->sizes[left + 1];
+        da_big_free_node(big, b, child_level);
+        da_big_move_items(big, level, &branch->node, left + 1, &branch->node, left + 2,
+                          branch->node.count - left - 2);
+        branch->node.count--;
+        return;
+    }
 
-    if (arr->length == 0) return;  /* Nothing to append */
+    da_int_t target = (a->count + b->count) / 2;
+    if (a->count > target) {
+        da_int_t n = a->count - target;
+        da_big_move_items(big, child_level, b, n, b, 0, b->count);
+        da_big_move_items(big, child_level, b, 0, a, target, n);
+        a->count -= n;
+        b->count += n;
+    } else {
+        da_int_t n = target - a->count;
+        da_big_move_items(big, child_level, a, a->count, b, 0, n);
+        da_big_move_items(big, child_level, b, 0, b, n, b->count - n);
+        a->count += n;
+        b->count -= n;
+    }
+    branch->sizes[left] = da_big_node_size(a, child_level);
+    branch->sizes[left + 1] = da_big_node_size(b, child_level);
+}
 
-    /* Ensure enough capacity */
-    int new_length = builder->length + arr->length;
-    if (new_length > builder->capacity) {
-        int new_capacity = da_builder_grow_capacity(builder->capacity, new_length);
-        builder->data = DA_REALLOC(builder->data, new_capacity * builder->element_size);
-        DA_ASSERT(builder->data != NULL);
-        builder->capacity = new_capacity;
+/* Removes count elements at index; the range lies inside a single leaf */
+static void da_big_erase(da_bigarray big, da_bignode* node, int level, da_int_t index, da_int_t count) {
+    if (level == 0) {
+        da_big_move_items(big, 0, node, index, node, index + count, node->count - index - count);
+        node->count -= count;
+        return;
+    }
+    da_bigbranch* branch = (da_bigbranch*)node;
+    da_int_t i = 0;
+    while (index >= branch->sizes[i]) {
+        index -= branch->sizes[i];
+        i++;
     }
+    da_big_erase(big, branch->children[i], level - 1, index, count);
+    branch->sizes[i] -= count;
+    da_big_fix_child(big, branch, level, i);
+}
 
-    /* Copy all elements from array at once */
-    void* dest_ptr = (char*)builder->data + (builder->length * builder->element_size);
-    memcpy(dest_ptr, arr->data, arr->length * arr->element_size);
-    builder->length = new_length;
+DA_DEF da_bigarray da_bigarray_create(da_int_t element_size, void (*retain_fn)(void*), void (*release_fn)(void*)) {
+    return da_bigarray_create_with_allocator(element_size, retain_fn, release_fn, NULL);
 }
 
-DA_DEF da_array da_builder_to_array(da_builder* builder, void (*retain_fn)(void*), void (*release_fn)(void*)) {
-    DA_ASSERT(builder != NULL);
-    DA_ASSERT(*builder != NULL);
+DA_DEF da_bigarray da_bigarray_create_with_allocator(da_int_t element_size, void (*retain_fn)(void*),
+                                                     void (*release_fn)(void*), const da_allocator* allocator) {
+    DA_ASSERT(element_size > 0);
+    DA_ASSERT(allocator == NULL || (allocator->alloc_fn != NULL && allocator->free_fn != NULL));
+
+    da_bigarray big = (da_bigarray)da_mem_alloc(allocator, sizeof(da_bigarray_t));
+    DA_ASSERT(big != NULL);
+    big->length = 0;
+    big->element_size = element_size;
+    big->leaf_capacity = DA_BIGARRAY_LEAF_BYTES / element_size;
+    if (big->leaf_capacity < 4) big->leaf_capacity = 4;
+    big->height = 0;
+    big->root = NULL;
+    big->retain_fn = retain_fn;
+    big->release_fn = release_fn;
+    big->allocator = allocator;
+    return big;
+}
 
-    da_builder b = *builder;
+DA_DEF void da_bigarray_destroy(da_bigarray* big) {
+    DA_ASSERT(big != NULL);
+    DA_ASSERT(*big != NULL);
 
-    /* Create new da_array */
-    da_array arr = (da_array)DA_MALLOC(sizeof(da_array_t));
-    DA_ASSERT(arr != NULL);
+    da_bigarray_clear(*big);
+    da_mem_free((*big)->allocator, *big, sizeof(da_bigarray_t));
+    *big = NULL;
+}
 
-    DA_ATOMIC_STORE(&arr->ref_count, 1);
-    arr->length = b->length;
-    arr->capacity = b->length;  /* Exact capacity = length */
-    arr->element_size = b->element_size;
-    arr->retain_fn = retain_fn;
-    arr->release_fn = release_fn;
+DA_DEF void da_bigarray_insert(da_bigarray big, da_int_t index, const void* element) {
+    DA_ASSERT(big != NULL);
+    DA_ASSERT(element != NULL);
+    DA_ASSERT(index >= 0 && index <= big->length);
+    DA_ASSERT(big->length < DA_INT_MAX);
 
-    if (b->length > 0) {
-        /* Shrink to exact size */
-        arr->data = DA_REALLOC(b->data, b->length * b->element_size);
-        DA_ASSERT(arr->data != NULL);
-        
-        /* Call retain function on all elements in the new array */
-        if (arr->retain_fn) {
-            for (int i = 0; i < arr->length; i++) {
-                void* element_ptr = (char*)arr->data + (i * arr->element_size);
-                arr->retain_fn(element_ptr);
-            }
-        }
-    } else {
-        arr->data = NULL;
-        if (b->data) {
-            DA_FREE(b->data);
-        }
+    if (big->root == NULL) {
+        big->root = da_big_new_node(big, 0);
     }
+    da_bignode* split = da_big_insert(big, big->root, big->height, index, element);
+    if (split != NULL) {
+        /* The root split: grow the tree by one level */
+        big->height++;
+        da_bigbranch* root = (da_bigbranch*)da_big_new_node(big, big->height);
+        root->children[0] = big->root;
+        root->children[1] = split;
+        root->sizes[1] = da_big_node_size(split, big->height - 1);
+        root->sizes[0] = big->length + 1 - root->sizes[1];
+        root->node.count = 2;
+        big->root = &root->node;
+    }
+    big->length++;
 
-    /* Free builder */
-    DA_FREE(b);
-    *builder = NULL;
-
-    return arr;
+    if (big->retain_fn) {
+        big->retain_fn(da_bigarray_get(big, index));
+    }
 }
 
-DA_DEF void da_builder_clear(da_builder builder) {
-    DA_ASSERT(builder != NULL);
-    builder->length = 0;
+DA_DEF void da_bigarray_push(da_bigarray big, const void* element) {
+    DA_ASSERT(big != NULL);
+    da_bigarray_insert(big, big->length, element);
 }
 
-DA_DEF void da_builder_destroy(da_builder* builder) {
-    DA_ASSERT(builder != NULL);
-    DA_ASSERT(*builder != NULL);
+DA_DEF void da_bigarray_remove(da_bigarray big, da_int_t index, void* out) {
+    DA_ASSERT(big != NULL);
+    DA_ASSERT(index >= 0 && index < big->length);
 
-    if ((*builder)->data) {
-        DA_FREE((*builder)->data);
+    if (out != NULL) {
+        memcpy(out, da_bigarray_get(big, index), big->element_size);
+    }
+    da_bigarray_remove_range(big, index, 1);
+}
+
+DA_DEF void da_bigarray_remove_range(da_bigarray big, da_int_t start, da_int_t count) {
+    DA_ASSERT(big != NULL);
+    DA_ASSERT(start >= 0 && count >= 0);
+    DA_ASSERT(start <= big->length - count);
+
+    while (count > 0) {
+        da_int_t available;
+        void* run = da_bigarray_span(big, start, &available);
+        da_int_t n = available < count ? available : count;
+        if (big->release_fn) {
+            for (da_int_t i = 0; i < n; i++) {
+                big->release_fn((char*)run + (i * big->element_size));
+            }
+        }
+        da_big_erase(big, big->root, big->height, start, n);
+        big->length -= n;
+        count -= n;
+
+        /* A root branch left with one child hands the root down */
+        while (big->height > 0 && big->root->count == 1) {
+            da_bignode* child = ((da_bigbranch*)big->root)->children[0];
+            da_big_free_node(big, big->root, big->height);
+            big->root = child;
+            big->height--;
+        }
     }
-    DA_FREE(*builder);
-    *builder = NULL;
 }
 
-DA_DEF int da_builder_length(da_builder builder) {
-    DA_ASSERT(builder != NULL);
-    return builder->length;
+DA_DEF void da_bigarray_pop(da_bigarray big, void* out) {
+    DA_ASSERT(big != NULL);
+    DA_ASSERT(big->length > 0);
+    da_bigarray_remove(big, big->length - 1, out);
 }
 
-DA_DEF int da_builder_capacity(da_builder builder) {
-    DA_ASSERT(builder != NULL);
-    return builder->capacity;
-}
+DA_DEF void* da_bigarray_get(da_bigarray big, da_int_t index) {
+    DA_ASSERT(big != NULL);
+    DA_ASSERT(index >= 0 && index < big->length);
 
-DA_DEF void* da_builder_get(da_builder builder, int index) {
-    DA_ASSERT(builder != NULL);
-    DA_ASSERT(index >= 0 && index < builder->length);
-    return (char*)builder->data + (index * builder->element_size);
+    da_int_t offset;
+    da_bignode* leaf = da_big_find(big, index, &offset);
+    return da_big_leaf_at(big, leaf, offset);
 }
 
-DA_DEF void da_builder_set(da_builder builder, int index, const void* element) {
-    DA_ASSERT(builder != NULL);
+DA_DEF void da_bigarray_set(da_bigarray big, da_int_t index, const void* element) {
     DA_ASSERT(element != NULL);
-    DA_ASSERT(index >= 0 && index < builder->length);
 
-    void* dest = (char*)builder->data + (index * builder->element_size);
-    memcpy(dest, element, builder->element_size);
+    void* dest = da_bigarray_get(big, index);
+    if (big->release_fn) {
+        big->release_fn(dest);
+    }
+    memcpy(dest, element, big->element_size);
+    if (big->retain_fn) {
+        big->retain_fn(dest);
+    }
 }
 
-/* Additional Array Functions Implementation */
+DA_DEF void* da_bigarray_span(da_bigarray big, da_int_t index, da_int_t* available) {
+    DA_ASSERT(big != NULL);
+    DA_ASSERT(available != NULL);
+    DA_ASSERT(index >= 0 && index < big->length);
 
-DA_DEF void* da_peek(da_array arr) {
-    DA_ASSERT(arr != NULL);
-    DA_ASSERT(arr->length > 0);
-    return (char*)arr->data + ((arr->length - 1) * arr->element_size);
+    da_int_t offset;
+    da_bignode* leaf = da_big_find(big, index, &offset);
+    *available = leaf->count - offset;
+    return da_big_leaf_at(big, leaf, offset);
 }
 
-DA_DEF void* da_peek_first(da_array arr) {
-    DA_ASSERT(arr != NULL);
-    DA_ASSERT(arr->length > 0);
-    return arr->data;
+DA_DEF da_int_t da_bigarray_length(da_bigarray big) {
+    DA_ASSERT(big != NULL);
+    return big->length;
 }
 
-DA_DEF void da_append_raw(da_array arr, const void* data, int count) {
-    DA_ASSERT(arr != NULL);
-    DA_ASSERT(data != NULL);
-    DA_ASSERT(count >= 0);
+DA_DEF void da_bigarray_clear(da_bigarray big) {
+    DA_ASSERT(big != NULL);
+    if (big->release_fn) {
+        da_int_t available;
+        for (da_int_t i = 0; i < big->length; i += available) {
+            char* run = (char*)da_bigarray_span(big, i, &available);
+            for (da_int_t j = 0; j < available; j++) {
+                big->release_fn(run + (j * big->element_size));
+            }
+        }
+    }
+    if (big->root != NULL) {
+        da_big_free_tree(big, big->root, big->height);
+    }
+    big->root = NULL;
+    big->height = 0;
+    big->length = 0;
+}
 
-    if (count == 0) return;  /* Nothing to append */
+DA_DEF void da_bigarray_export(da_bigarray big, void* dest) {
+    DA_ASSERT(big != NULL);
+    DA_ASSERT(dest != NULL || big->length == 0);
 
-    /* Ensure enough capacity */
-    int new_length = arr->length + count;
-    if (new_length > arr->capacity) {
-        int new_capacity = da_grow_capacity(arr->capacity, new_length);
-        arr->data = DA_REALLOC(arr->data, new_capacity * arr->element_size);
-        DA_ASSERT(arr->data != NULL);
-        arr->capacity = new_capacity;
+    da_int_t available;
+    char* out = (char*)dest;
+    for (da_int_t i = 0; i < big->length; i += available) {
+        void* run = da_bigarray_span(big, i, &available);
+        memcpy(out, run, (size_t)available * big->element_size);
+        out += (size_t)available * big->element_size;
     }
+}
 
-    /* Copy all elements at once */
-    void* dest_ptr = (char*)arr->data + (arr->length * arr->element_size);
-    memcpy(dest_ptr, data, count * arr->element_size);
-    
-    /* Call retain function on all copied elements */
-    if (arr->retain_fn) {
-        for (int i = arr->length; i < new_length; i++) {
-            void* element_ptr = (char*)arr->data + (i * arr->element_size);
-            arr->retain_fn(element_ptr);
-        }
+DA_DEF da_array da_bigarray_to_array(da_bigarray big) {
+    DA_ASSERT(big != NULL);
+
+    da_array arr = da_create_with_allocator(big->element_size, big->length, big->retain_fn, big->release_fn,
+                                            big->allocator);
+    da_int_t available;
+    for (da_int_t i = 0; i < big->length; i += available) {
+        void* run = da_bigarray_span(big, i, &available);
+        da_append_raw(arr, run, available);
     }
-    
-    arr->length = new_length;
+    return arr;
 }
 
-DA_DEF void da_fill(da_array arr, const void* element, int count) {
-    DA_ASSERT(arr != NULL);
-    DA_ASSERT(element != NULL);
-    DA_ASSERT(count >= 0);
-
-    if (count == 0) return;  /* Nothing to fill */
+/* Persistent Vector Implementation */
 
-    /* Ensure enough capacity */
-    int new_length = arr->length + count;
-    if (new_length > arr->capacity) {
-        int new_capacity = da_grow_capacity(arr->capacity, new_length);
-        arr->data = DA_REALLOC(arr->data, new_capacity * arr->element_size);
-        DA_ASSERT(arr->data != NULL);
-        arr->capacity = new_capacity;
-    }
+#define DA_PVEC_BITS 5
+#define DA_PVEC_WIDTH (1 << DA_PVEC_BITS)
+#define DA_PVEC_MASK (DA_PVEC_WIDTH - 1)
 
-    /* Fill elements one by one */
-    for (int i = 0; i < count; i++) {
-        void* dest_ptr = (char*)arr->data + ((arr->length + i) * arr->element_size);
-        memcpy(dest_ptr, element, arr->element_size);
-    }
-    arr->length = new_length;
+/* Branch entries are da_array children; copying or dropping an entry retains or releases it */
+static void da_pvec_retain_child(void* slot) {
+    da_retain(*(da_array*)slot);
 }
 
-DA_DEF da_array da_slice(da_array arr, int start, int end) {
-    DA_ASSERT(arr != NULL);
-    DA_ASSERT(start >= 0 && start <= arr->length);
-    DA_ASSERT(end >= start && end <= arr->length);
+static void da_pvec_release_child(void* slot) {
+    da_release((da_array*)slot);
+}
 
-    int slice_length = end - start;
+static da_array da_pvec_new_leaf(da_pvec pvec) {
+    return da_create_with_allocator(pvec->element_size, DA_PVEC_WIDTH, pvec->retain_fn, pvec->release_fn,
+                                    pvec->allocator);
+}
 
-    /* Create new array with exact capacity */
-    da_array result = (da_array)DA_MALLOC(sizeof(da_array_t));
-    DA_ASSERT(result != NULL);
+static da_array da_pvec_new_branch(da_pvec pvec) {
+    return da_create_with_allocator(sizeof(da_array), DA_PVEC_WIDTH, da_pvec_retain_child, da_pvec_release_child,
+                                    pvec->allocator);
+}
 
-    DA_ATOMIC_STORE(&result->ref_count, 1);
-    result->length = slice_length;
-    result->capacity = slice_length;  /* Exact capacity */
-    result->element_size = arr->element_size;
-    result->retain_fn = arr->retain_fn;   /* Inherit retain function */
-    result->release_fn = arr->release_fn;  /* Inherit release function */
+/* Private copy of a node with room for a full node; every entry is retained once more */
+static da_array da_pvec_copy_node(da_array node) {
+    da_array copy = da_create_with_allocator(node->element_size, DA_PVEC_WIDTH, node->retain_fn, node->release_fn,
+                                             node->allocator);
+    da_append_array(copy, node);
+    return copy;
+}
 
-    if (slice_length > 0) {
-        result->data = DA_MALLOC(slice_length * result->element_size);
-        DA_ASSERT(result->data != NULL);
+static da_array da_pvec_child(da_array branch, da_int_t i) {
+    return *(da_array*)da_get(branch, i);
+}
 
-        /* Copy slice elements */
-        void* src_ptr = (char*)arr->data + (start * arr->element_size);
-        memcpy(result->data, src_ptr, slice_length * arr->element_size);
-        
-        /* Call retain function on all copied elements */
-        if (result->retain_fn) {
-            for (int i = 0; i < result->length; i++) {
-                void* element_ptr = (char*)result->data + (i * result->element_size);
-                result->retain_fn(element_ptr);
-            }
-        }
+/* Stores child at position i of branch (appending when i == length) and gives up our reference */
+static void da_pvec_put_child(da_array branch, da_int_t i, da_array child) {
+    if (i < da_length(branch)) {
+        da_set(branch, i, &child);
     } else {
-        result->data = NULL;
+        da_push(branch, &child);
     }
+    da_release(&child);
+}
 
-    return result;
+static da_pvec da_pvec_new_version(da_pvec pvec) {
+    da_pvec next = (da_pvec)da_mem_alloc(pvec->allocator, sizeof(da_pvec_t));
+    DA_ASSERT(next != NULL);
+    DA_ATOMIC_STORE(&next->ref_count, 1);
+    next->length = pvec->length;
+    next->element_size = pvec->element_size;
+    next->shift = pvec->shift;
+    next->root = NULL;
+    next->tail = NULL;
+    next->retain_fn = pvec->retain_fn;
+    next->release_fn = pvec->release_fn;
+    next->allocator = pvec->allocator;
+    return next;
 }
 
-DA_DEF void da_remove_range(da_array arr, int start, int count) {
-    DA_ASSERT(arr != NULL);
-    DA_ASSERT(start >= 0 && start < arr->length);
-    DA_ASSERT(count >= 0);
-    DA_ASSERT(start + count <= arr->length);
+static da_int_t da_pvec_tail_offset(da_pvec pvec) {
+    return pvec->tail ? pvec->length - da_length(pvec->tail) : 0;
+}
 
-    if (count == 0) return;  /* Nothing to remove */
+/* The leaf (or the tail) that holds index */
+static da_array da_pvec_leaf_for(da_pvec pvec, da_int_t index) {
+    if (index >= da_pvec_tail_offset(pvec)) return pvec->tail;
+    da_array node = pvec->root;
+    for (int level = pvec->shift; level > 0; level -= DA_PVEC_BITS) {
+        node = da_pvec_child(node, (index >> level) & DA_PVEC_MASK);
+    }
+    return node;
+}
 
-    int end = start + count;
+/* A chain of single-child branches from level down to leaf */
+static da_array da_pvec_new_path(da_pvec pvec, int level, da_array leaf) {
+    if (level == 0) return da_retain(leaf);
+    da_array branch = da_pvec_new_branch(pvec);
+    da_pvec_put_child(branch, 0, da_pvec_new_path(pvec, level - DA_PVEC_BITS, leaf));
+    return branch;
+}
 
-    /* Call destructor on elements being removed */
-    if (arr->release_fn) {
-        for (int i = start; i < end; i++) {
-            void* element_ptr = (char*)arr->data + (i * arr->element_size);
-            arr->release_fn(element_ptr);
-        }
+/* Copy of the path from parent to the slot of leaf number tree_length / 32, with leaf stored there */
+static da_array da_pvec_push_leaf(da_pvec pvec, int level, da_array parent, da_int_t tree_length, da_array leaf) {
+    da_array copy = parent ? da_pvec_copy_node(parent) : da_pvec_new_branch(pvec);
+    da_int_t i = (tree_length >> level) & DA_PVEC_MASK;
+    da_array child;
+    if (level == DA_PVEC_BITS) {
+        child = da_retain(leaf);
+    } else if (i < da_length(copy)) {
+        child = da_pvec_push_leaf(pvec, level - DA_PVEC_BITS, da_pvec_child(copy, i), tree_length, leaf);
+    } else {
+        child = da_pvec_new_path(pvec, level - DA_PVEC_BITS, leaf);
     }
+    da_pvec_put_child(copy, i, child);
+    return copy;
+}
 
-    /* Shift elements after the range to the left */
-    if (end < arr->length) {
-        void* dest = (char*)arr->data + (start * arr->element_size);
-        void* src = (char*)arr->data + (end * arr->element_size);
-        int bytes_to_move = (arr->length - end) * arr->element_size;
-        memmove(dest, src, bytes_to_move);
+/* Sets next->root/shift to the tree of root/shift with leaf appended after tree_length elements */
+static void da_pvec_append_leaf(da_pvec next, da_array root, int shift, da_int_t tree_length, da_array leaf) {
+    if (root != NULL && (unsigned long long)tree_length == 1ULL << (shift + DA_PVEC_BITS)) {
+        /* Full trie: add a level */
+        next->root = da_pvec_new_branch(next);
+        da_pvec_put_child(next->root, 0, da_retain(root));
+        da_pvec_put_child(next->root, 1, da_pvec_new_path(next, shift, leaf));
+        next->shift = shift + DA_PVEC_BITS;
+    } else {
+        next->root = da_pvec_push_leaf(next, shift, root, tree_length, leaf);
+        next->shift = shift;
     }
-
-    arr->length -= count;
 }
 
-DA_DEF void da_reverse(da_array arr) {
-    DA_ASSERT(arr != NULL);
-
-    if (arr->length <= 1) return;  /* Nothing to reverse */
-
-    char* temp = (char*)DA_MALLOC(arr->element_size);
-    DA_ASSERT(temp != NULL);
-
-    /* Swap elements from both ends moving toward center */
-    for (int i = 0; i < arr->length / 2; i++) {
-        int j = arr->length - 1 - i;
+/* Copy of the path to the last leaf of a tree holding tree_length elements, without that leaf
+ * (NULL when nothing is left under node) */
+static da_array da_pvec_pop_leaf(da_pvec pvec, int level, da_array node, da_int_t tree_length) {
+    da_int_t i = ((tree_length - 1) >> level) & DA_PVEC_MASK;
+    da_array child = NULL;
+    if (level > DA_PVEC_BITS) {
+        child = da_pvec_pop_leaf(pvec, level - DA_PVEC_BITS, da_pvec_child(node, i), tree_length);
+    }
+    if (child == NULL && i == 0) return NULL;
 
-        char* left = (char*)arr->data + (i * arr->element_size);
-        char* right = (char*)arr->data + (j * arr->element_size);
+    da_array copy = da_pvec_copy_node(node);
+    if (child == NULL) {
+        da_pop(copy, NULL);
+    } else {
+        da_pvec_put_child(copy, i, child);
+    }
+    return copy;
+}
 
-        /* Three-way swap using temp buffer */
-        memcpy(temp, left, arr->element_size);
-        memcpy(left, right, arr->element_size);
-        memcpy(right, temp, arr->element_size);
+static da_array da_pvec_set_in(da_pvec pvec, int level, da_array node, da_int_t index, const void* element) {
+    da_array copy = da_pvec_copy_node(node);
+    if (level == 0) {
+        da_set(copy, index & DA_PVEC_MASK, element);
+    } else {
+        da_int_t i = (index >> level) & DA_PVEC_MASK;
+        da_pvec_put_child(copy, i, da_pvec_set_in(pvec, level - DA_PVEC_BITS, da_pvec_child(node, i), index, element));
     }
+    return copy;
+}
+
+DA_DEF da_pvec da_pvec_create(da_int_t element_size, void (*retain_fn)(void*), void (*release_fn)(void*)) {
+    return da_pvec_create_with_allocator(element_size, retain_fn, release_fn, NULL);
+}
 
-    DA_FREE(temp);
+DA_DEF da_pvec da_pvec_create_with_allocator(da_int_t element_size, void (*retain_fn)(void*),
+                                             void (*release_fn)(void*), const da_allocator* allocator) {
+    DA_ASSERT(element_size > 0);
+    DA_ASSERT(allocator == NULL || (allocator->alloc_fn != NULL && allocator->free_fn != NULL));
+
+    da_pvec_t proto;
+    proto.length = 0;
+    proto.element_size = element_size;
+    proto.shift = DA_PVEC_BITS;
+    proto.retain_fn = retain_fn;
+    proto.release_fn = release_fn;
+    proto.allocator = allocator;
+    return da_pvec_new_version(&proto);
 }
 
-DA_DEF void da_swap(da_array arr, int i, int j) {
+DA_DEF da_pvec da_pvec_from_array(da_array arr) {
     DA_ASSERT(arr != NULL);
-    DA_ASSERT(i >= 0 && i < arr->length);
-    DA_ASSERT(j >= 0 && j < arr->length);
 
-    if (i == j) return;  /* No-op if same index */
+    da_pvec pvec = da_pvec_create_with_allocator(arr->element_size, arr->retain_fn, arr->release_fn,
+                                                 arr->allocator);
+    da_int_t length = da_length(arr);
+    da_int_t tree_length = length > 0 ? ((length - 1) >> DA_PVEC_BITS) << DA_PVEC_BITS : 0;
+    const char* data = (const char*)da_data(arr);
+
+    for (da_int_t start = 0; start < tree_length; start += DA_PVEC_WIDTH) {
+        da_array leaf = da_pvec_new_leaf(pvec);
+        da_append_raw(leaf, data + (start * arr->element_size), DA_PVEC_WIDTH);
+        da_array old_root = pvec->root;
+        da_pvec_append_leaf(pvec, old_root, pvec->shift, start, leaf);
+        if (old_root != NULL) da_release(&old_root);
+        da_release(&leaf);
+    }
+    if (length > 0) {
+        pvec->tail = da_pvec_new_leaf(pvec);
+        da_append_raw(pvec->tail, data + (tree_length * arr->element_size), length - tree_length);
+    }
+    pvec->length = length;
+    return pvec;
+}
 
-    char* temp = (char*)DA_MALLOC(arr->element_size);
-    DA_ASSERT(temp != NULL);
+DA_DEF da_array da_pvec_to_array(da_pvec pvec) {
+    DA_ASSERT(pvec != NULL);
 
-    char* elem_i = (char*)arr->data + (i * arr->element_size);
-    char* elem_j = (char*)arr->data + (j * arr->element_size);
+    da_array arr = da_create_with_allocator(pvec->element_size, pvec->length, pvec->retain_fn, pvec->release_fn,
+                                            pvec->allocator);
+    for (da_int_t i = 0; i < pvec->length; i += DA_PVEC_WIDTH) {
+        da_append_array(arr, da_pvec_leaf_for(pvec, i));
+    }
+    return arr;
+}
+
+DA_DEF da_pvec da_pvec_retain(da_pvec pvec) {
+    DA_ASSERT(pvec != NULL);
+    (void)DA_ATOMIC_FETCH_ADD(&pvec->ref_count, 1);
+    return pvec;
+}
 
-    /* Three-way swap */
-    memcpy(temp, elem_i, arr->element_size);
-    memcpy(elem_i, elem_j, arr->element_size);
-    memcpy(elem_j, temp, arr->element_size);
+DA_DEF void da_pvec_release(da_pvec* pvec) {
+    DA_ASSERT(pvec != NULL);
+    DA_ASSERT(*pvec != NULL);
 
-    DA_FREE(temp);
+    if (DA_ATOMIC_FETCH_SUB(&(*pvec)->ref_count, 1) == 1) {
+        if ((*pvec)->root) da_release(&(*pvec)->root);
+        if ((*pvec)->tail) da_release(&(*pvec)->tail);
+        da_mem_free((*pvec)->allocator, *pvec, sizeof(da_pvec_t));
+    }
+    *pvec = NULL;
 }
 
-DA_DEF da_array da_copy(da_array arr) {
-    DA_ASSERT(arr != NULL);
+DA_DEF da_pvec da_pvec_set(da_pvec pvec, da_int_t index, const void* element) {
+    DA_ASSERT(pvec != NULL);
+    DA_ASSERT(element != NULL);
+    DA_ASSERT(index >= 0 && index < pvec->length);
 
-    /* Create new array with exact capacity = length */
-    da_array result = (da_array)DA_MALLOC(sizeof(da_array_t));
-    DA_ASSERT(result != NULL);
+    da_pvec next = da_pvec_new_version(pvec);
+    if (index >= da_pvec_tail_offset(pvec)) {
+        next->root = pvec->root ? da_retain(pvec->root) : NULL;
+        next->tail = da_pvec_copy_node(pvec->tail);
+        da_set(next->tail, index & DA_PVEC_MASK, element);
+    } else {
+        next->root = da_pvec_set_in(pvec, pvec->shift, pvec->root, index, element);
+        next->tail = da_retain(pvec->tail);
+    }
+    return next;
+}
 
-    DA_ATOMIC_STORE(&result->ref_count, 1);
-    result->length = arr->length;
-    result->capacity = arr->length;  /* Exact capacity for efficiency */
-    result->element_size = arr->element_size;
-    result->retain_fn = arr->retain_fn;   /* Inherit retain function */
-    result->release_fn = arr->release_fn;  /* Inherit release function */
+DA_DEF da_pvec da_pvec_push(da_pvec pvec, const void* element) {
+    DA_ASSERT(pvec != NULL);
+    DA_ASSERT(element != NULL);
+    DA_ASSERT(pvec->length < DA_INT_MAX);
 
-    if (arr->length > 0) {
-        result->data = DA_MALLOC(arr->length * arr->element_size);
-        DA_ASSERT(result->data != NULL);
+    da_pvec next = da_pvec_new_version(pvec);
+    if (pvec->tail == NULL || da_length(pvec->tail) < DA_PVEC_WIDTH) {
+        next->root = pvec->root ? da_retain(pvec->root) : NULL;
+        next->tail = pvec->tail ? da_pvec_copy_node(pvec->tail) : da_pvec_new_leaf(pvec);
+    } else {
+        /* The full tail becomes a leaf of the trie, shared with this version */
+        da_pvec_append_leaf(next, pvec->root, pvec->shift, pvec->length - DA_PVEC_WIDTH, pvec->tail);
+        next->tail = da_pvec_new_leaf(pvec);
+    }
+    da_push(next->tail, element);
+    next->length++;
+    return next;
+}
 
-        /* Copy all elements */
-        memcpy(result->data, arr->data, arr->length * arr->element_size);
-        
-        /* Call retain function on all copied elements */
-        if (result->retain_fn) {
-            for (int i = 0; i < result->length; i++) {
-                void* element_ptr = (char*)result->data + (i * result->element_size);
-                result->retain_fn(element_ptr);
-            }
-        }
+DA_DEF da_pvec da_pvec_pop(da_pvec pvec, void* out) {
+    DA_ASSERT(pvec != NULL);
+    DA_ASSERT(pvec->length > 0);
+
+    if (out != NULL) {
+        memcpy(out, da_pvec_get(pvec, pvec->length - 1), pvec->element_size);
+    }
+    da_pvec next = da_pvec_new_version(pvec);
+    next->length--;
+    if (pvec->length == 1) {
+        next->shift = DA_PVEC_BITS;
+    } else if (da_length(pvec->tail) > 1) {
+        next->root = pvec->root ? da_retain(pvec->root) : NULL;
+        next->tail = da_pvec_copy_node(pvec->tail);
+        da_pop(next->tail, NULL);
     } else {
-        result->data = NULL;
+        /* The last leaf of the trie becomes the tail */
+        da_int_t tree_length = pvec->length - 1;
+        next->tail = da_retain(da_pvec_leaf_for(pvec, tree_length - 1));
+        next->root = da_pvec_pop_leaf(pvec, pvec->shift, pvec->root, tree_length);
+        if (next->root == NULL) {
+            next->shift = DA_PVEC_BITS;
+        } else if (next->shift > DA_PVEC_BITS && da_length(next->root) == 1) {
+            da_array child = da_retain(da_pvec_child(next->root, 0));
+            da_release(&next->root);
+            next->root = child;
+            next->shift -= DA_PVEC_BITS;
+        }
     }
+    return next;
+}
 
-    return result;
+DA_DEF const void* da_pvec_get(da_pvec pvec, da_int_t index) {
+    DA_ASSERT(pvec != NULL);
+    DA_ASSERT(index >= 0 && index < pvec->length);
+    return da_get(da_pvec_leaf_for(pvec, index), index & DA_PVEC_MASK);
 }
 
-DA_DEF da_array da_filter(da_array arr, int (*predicate)(const void* element, void* context), void* context) {
-    DA_ASSERT(arr != NULL);
-    DA_ASSERT(predicate != NULL);
+DA_DEF da_int_t da_pvec_length(da_pvec pvec) {
+    DA_ASSERT(pvec != NULL);
+    return pvec->length;
+}
 
-    /* Use builder for single-pass filtering */
-    da_builder builder = da_builder_create(arr->element_size);
+/* Rope Implementation */
+
+static da_rope da_rope_new_node(da_int_t element_size, void (*retain_fn)(void*), void (*release_fn)(void*),
+                                const da_allocator* allocator) {
+    da_rope rope = (da_rope)da_mem_alloc(allocator, sizeof(da_rope_t));
+    DA_ASSERT(rope != NULL);
+    DA_ATOMIC_STORE(&rope->ref_count, 1);
+    rope->length = 0;
+    rope->element_size = element_size;
+    rope->leaf = NULL;
+    rope->left = NULL;
+    rope->right = NULL;
+    rope->retain_fn = retain_fn;
+    rope->release_fn = release_fn;
+    rope->allocator = allocator;
+    return rope;
+}
 
-    /* Single pass: test and append matching elements */
-    for (int i = 0; i < arr->length; i++) {
-        void* element_ptr = (char*)arr->data + (i * arr->element_size);
-        if (predicate(element_ptr, context)) {
-            da_builder_append(builder, element_ptr);
-        }
-    }
+static void da_rope_append_chunk(const void* data, da_int_t count, void* context) {
+    da_append_raw((da_array)context, data, count);
+}
 
-    /* Convert builder to array with exact capacity, inherit destructor */
-    da_array result = da_builder_to_array(&builder, arr->retain_fn, arr->release_fn);
-    return result;
+/* Replaces a concatenation by a leaf holding its elements in one array */
+static void da_rope_flatten(da_rope rope) {
+    if (rope->left == NULL) return;
+
+    da_array flat = da_create_with_allocator(rope->element_size, rope->length, rope->retain_fn, rope->release_fn,
+                                             rope->allocator);
+    da_rope_for_each_chunk(rope, da_rope_append_chunk, flat);
+    rope->leaf = flat;
+    da_rope_release(&rope->left);
+    da_rope_release(&rope->right);
 }
 
-DA_DEF da_array da_map(da_array arr, void (*mapper)(const void* src, void* dst, void* context), void* context) {
+DA_DEF da_rope da_rope_from_array(da_array arr) {
     DA_ASSERT(arr != NULL);
-    DA_ASSERT(mapper != NULL);
 
-    /* Create new array with same length and exact capacity */
-    da_array result = (da_array)DA_MALLOC(sizeof(da_array_t));
-    DA_ASSERT(result != NULL);
+    da_rope rope = da_rope_new_node(arr->element_size, arr->retain_fn, arr->release_fn, arr->allocator);
+    rope->leaf = da_retain(arr);
+    rope->length = da_length(arr);
+    return rope;
+}
 
-    DA_ATOMIC_STORE(&result->ref_count, 1);
-    result->length = arr->length;
-    result->capacity = arr->length;  /* Exact capacity for efficiency */
-    result->element_size = arr->element_size;
-    result->retain_fn = arr->retain_fn;   /* Inherit retain function */
-    result->release_fn = arr->release_fn;  /* Inherit release function */
+DA_DEF da_rope da_rope_concat(da_rope left, da_rope right) {
+    DA_ASSERT(left != NULL);
+    DA_ASSERT(right != NULL);
+    DA_ASSERT(left->element_size == right->element_size);
 
-    if (arr->length > 0) {
-        result->data = DA_MALLOC(arr->length * arr->element_size);
-        DA_ASSERT(result->data != NULL);
-
-        /* Transform each element */
-        for (int i = 0; i < arr->length; i++) {
-            void* src_ptr = (char*)arr->data + (i * arr->element_size);
-            void* dst_ptr = (char*)result->data + (i * arr->element_size);
-            mapper(src_ptr, dst_ptr, context);
-        }
-    } else {
-        result->data = NULL;
-    }
+    if (right->length == 0) return da_rope_retain(left);
+    if (left->length == 0) return da_rope_retain(right);
+
+    da_rope rope = da_rope_new_node(left->element_size, left->retain_fn, left->release_fn, left->allocator);
+    rope->length = da_add_length(left->length, right->length);
+    rope->left = da_rope_retain(left);
+    rope->right = da_rope_retain(right);
+    return rope;
+}
 
+DA_DEF da_rope da_rope_append(da_rope rope, da_array arr) {
+    da_rope leaf = da_rope_from_array(arr);
+    da_rope result = da_rope_concat(rope, leaf);
+    da_rope_release(&leaf);
     return result;
 }
 
-DA_DEF void da_reduce(da_array arr, const void* initial, void* result,
-                      void (*reducer)(void* accumulator, const void* element, void* context), void* context) {
-    DA_ASSERT(arr != NULL);
-    DA_ASSERT(initial != NULL);
-    DA_ASSERT(result != NULL);
-    DA_ASSERT(reducer != NULL);
+DA_DEF da_rope da_rope_retain(da_rope rope) {
+    DA_ASSERT(rope != NULL);
+    (void)DA_ATOMIC_FETCH_ADD(&rope->ref_count, 1);
+    return rope;
+}
 
-    /* Initialize result with initial value */
-    memcpy(result, initial, arr->element_size);
+DA_DEF void da_rope_release(da_rope* rope) {
+    DA_ASSERT(rope != NULL);
+    DA_ASSERT(*rope != NULL);
+
+    da_rope node = *rope;
+    *rope = NULL;
+    if (DA_ATOMIC_FETCH_SUB(&node->ref_count, 1) != 1) return;
+
+    /* Nodes whose last reference we dropped, kept on the heap instead of the C stack */
+    da_array dead = NULL;
+    for (;;) {
+        if (node->left != NULL) {
+            da_rope operands[2] = { node->left, node->right };
+            for (int i = 0; i < 2; i++) {
+                if (DA_ATOMIC_FETCH_SUB(&operands[i]->ref_count, 1) == 1) {
+                    if (dead == NULL) dead = da_create(sizeof(da_rope), 0, NULL, NULL);
+                    da_push(dead, &operands[i]);
+                }
+            }
+        }
+        if (node->leaf != NULL) {
+            da_release(&node->leaf);
+        }
+        da_mem_free(node->allocator, node, sizeof(da_rope_t));
 
-    /* Apply reducer to each element */
-    for (int i = 0; i < arr->length; i++) {
-        void* element_ptr = (char*)arr->data + (i * arr->element_size);
-        reducer(result, element_ptr, context);
+        if (dead == NULL || da_length(dead) == 0) break;
+        da_pop(dead, &node);
+    }
+    if (dead != NULL) {
+        da_release(&dead);
     }
 }
 
-DA_DEF int da_is_empty(da_array arr) {
-    DA_ASSERT(arr != NULL);
-    return arr->length == 0;
+DA_DEF da_int_t da_rope_length(da_rope rope) {
+    DA_ASSERT(rope != NULL);
+    return rope->length;
 }
 
-DA_DEF int da_find_index(da_array arr, int (*predicate)(const void* element, void* context), void* context) {
-    DA_ASSERT(arr != NULL);
-    DA_ASSERT(predicate != NULL);
-    
-    for (int i = 0; i < arr->length; i++) {
-        void* element_ptr = (char*)arr->data + (i * arr->element_size);
-        if (predicate(element_ptr, context)) {
-            return i;
+DA_DEF void da_rope_for_each_chunk(da_rope rope, void (*fn)(const void* data, da_int_t count, void* context),
+                                   void* context) {
+    DA_ASSERT(rope != NULL);
+    DA_ASSERT(fn != NULL);
+
+    /* In-order walk; right operands wait on a heap stack so long append chains cannot overflow */
+    da_array pending = NULL;
+    da_rope node = rope;
+    for (;;) {
+        while (node->left != NULL) {
+            if (pending == NULL) pending = da_create(sizeof(da_rope), 0, NULL, NULL);
+            da_push(pending, &node->right);
+            node = node->left;
         }
+        if (node->length > 0) {
+            fn(da_data(node->leaf), node->length, context);
+        }
+        if (pending == NULL || da_length(pending) == 0) break;
+        da_pop(pending, &node);
+    }
+    if (pending != NULL) {
+        da_release(&pending);
     }
-    
-    return -1;  // Not found
 }
 
-DA_DEF int da_contains(da_array arr, int (*predicate)(const void* element, void* context), void* context) {
-    return da_find_index(arr, predicate, context) != -1;
+DA_DEF const void* da_rope_get(da_rope rope, da_int_t index) {
+    DA_ASSERT(rope != NULL);
+    DA_ASSERT(index >= 0 && index < rope->length);
+    da_rope_flatten(rope);
+    return da_get(rope->leaf, index);
 }
 
-// Helper structure for qsort context
-struct da_sort_context {
-    int (*compare)(const void* a, const void* b, void* context);
-    void* user_context;
-};
-
-// Global context for qsort (not thread-safe, but qsort isn't either)
-static struct da_sort_context* da_sort_global_context = NULL;
-
-// qsort comparison wrapper
-static int da_sort_compare_wrapper(const void* a, const void* b) {
-    struct da_sort_context* ctx = (struct da_sort_context*)da_sort_global_context;
-    return ctx->compare(a, b, ctx->user_context);
+DA_DEF const void* da_rope_data(da_rope rope) {
+    DA_ASSERT(rope != NULL);
+    da_rope_flatten(rope);
+    return da_data(rope->leaf);
 }
 
-DA_DEF void da_sort(da_array arr, int (*compare)(const void* a, const void* b, void* context), void* context) {
-    DA_ASSERT(arr != NULL);
-    DA_ASSERT(compare != NULL);
-    
-    if (arr->length <= 1) {
-        return;  // Already sorted or empty
-    }
-    
-    // Set up global context for qsort wrapper
-    struct da_sort_context sort_ctx = { compare, context };
-    da_sort_global_context = &sort_ctx;
-    
-    // Use standard library qsort
-    qsort(arr->data, arr->length, arr->element_size, da_sort_compare_wrapper);
-    
-    // Clean up global context
-    da_sort_global_context = NULL;
+DA_DEF da_array da_rope_to_array(da_rope rope) {
+    DA_ASSERT(rope != NULL);
+    da_rope_flatten(rope);
+    return da_retain(rope->leaf);
 }
 
 #endif /* DA_IMPLEMENTATION */